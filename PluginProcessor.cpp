@@ -32,6 +32,7 @@ RPBasicSynthesizerAudioProcessor::RPBasicSynthesizerAudioProcessor()
 
 RPBasicSynthesizerAudioProcessor::~RPBasicSynthesizerAudioProcessor()
 {
+    cancelPendingUpdate();
     m_apvts = nullptr;
 }
 
@@ -70,7 +71,7 @@ bool RPBasicSynthesizerAudioProcessor::isMidiEffect() const
 
 double RPBasicSynthesizerAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return m_synthesizer.getTailLengthSeconds();
 }
 
 int RPBasicSynthesizerAudioProcessor::getNumPrograms()
@@ -104,6 +105,8 @@ void RPBasicSynthesizerAudioProcessor::prepareToPlay (double sampleRate, int sam
     // initialisation that you need..
     m_synthesizer.prepare((float)sampleRate, samplesPerBlock);
     m_synthesizer.prepareParameters((float)sampleRate, samplesPerBlock);
+    m_reportedLatency = (int)m_synthesizer.getLatencySamples();
+    setLatencySamples(m_reportedLatency);
 }
 
 void RPBasicSynthesizerAudioProcessor::releaseResources()
@@ -160,6 +163,16 @@ void RPBasicSynthesizerAudioProcessor::processBlock (juce::AudioBuffer<float>& b
     // Alternatively, you can process the samples with the channels
     // interleaved by keeping the same state.
     m_synthesizer.processBlock(midiMessages, buffer);
+
+    // filter oversampling was switched
+    if ((int)m_synthesizer.getLatencySamples() != m_reportedLatency.load())
+        triggerAsyncUpdate();
+}
+
+void RPBasicSynthesizerAudioProcessor::handleAsyncUpdate()
+{
+    m_reportedLatency = (int)m_synthesizer.getLatencySamples();
+    setLatencySamples(m_reportedLatency);
 }
 
 //==============================================================================
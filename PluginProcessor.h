@@ -14,7 +14,8 @@
 //==============================================================================
 /**
 */
-class RPBasicSynthesizerAudioProcessor  : public juce::AudioProcessor
+class RPBasicSynthesizerAudioProcessor  : public juce::AudioProcessor,
+                                           private juce::AsyncUpdater
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -60,6 +61,10 @@ public:
     rpSynth::audio::BasicSynthesizer m_synthesizer{"synth"};
     std::unique_ptr<juce::AudioProcessorValueTreeState> m_apvts;
 private:
+    // latency changes with filter oversampling,tell the host from the message thread
+    void handleAsyncUpdate() override;
+    std::atomic<int> m_reportedLatency = 0;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RPBasicSynthesizerAudioProcessor)
 };
@@ -22,6 +22,12 @@
 #define NAMESPACE_RPSYNTH_UI NAMESPACE_RPSYNTH::ui
 #define NAMESPACE_RPSYNTH_AUDIO_EFFECTS NAMESPACE_RPSYNTH_AUDIO::effects
 
+// Set this to 1 to build synthesizer/ without any ui/ code,
+// e.g. for the offline renderer in tools/
+#ifndef RPSYNTH_HEADLESS
+ #define RPSYNTH_HEADLESS 0
+#endif
+
 namespace rpSynth {
 template<typename Type>
 static Type semitoneToHertz(Type semitone, Type frequencyOfA = static_cast<Type>(440)) noexcept {
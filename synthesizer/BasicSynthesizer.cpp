@@ -16,11 +16,47 @@ namespace rpSynth::audio {
 // You must add it to next 4 methods
 void BasicSynthesizer::prepare(FType sampleRate,
                                size_t numSamplesPerBlock) {
+    // helper thread may still work on last block
+    if (m_pipelineWorker != nullptr) {
+        m_pipelineWorker->wait();
+    }
+
+    // every buffer below is taken from the arena again,prepareParameters continues it
+    m_bufferArena.reset();
+    ScopedBufferArena arenaScope{m_bufferArena};
+
+    // every buffer holds one micro block,host blocks of any size are split into them.
+    // A span covers the host block,voices render and the stages hand over once per span
+    m_microBlockSize = juce::jmax<size_t>(1, juce::jmin<size_t>(m_microBlockSizeRequested, numSamplesPerBlock));
+    m_numMicroBlocksPerSpan = juce::jmax<size_t>(1, (numSamplesPerBlock + m_microBlockSize - 1) / m_microBlockSize);
+    m_spanSize = m_microBlockSize * m_numMicroBlocksPerSpan;
+    numSamplesPerBlock = m_microBlockSize;
+
+    m_polyOscillor.setNumMicroBlocksPerSpan(m_numMicroBlocksPerSpan);
     m_polyOscillor.prepare(sampleRate, numSamplesPerBlock);
     m_LFOModulationManager.prepare(sampleRate, numSamplesPerBlock);
     m_EnvModulationManager.prepare(sampleRate, numSamplesPerBlock);
+    m_modulationMatrix.prepare(sampleRate);
     m_filter.prepare(sampleRate, numSamplesPerBlock);
     m_fxChain.prepare(sampleRate, numSamplesPerBlock);
+    m_filterInput.resize(numSamplesPerBlock);
+
+    // pipeline init
+    m_isPipelined = m_pipelineRequested;
+    m_pipelineLatency = m_spanSize;
+    m_pipelineNumSamples = 0;
+    if (m_isPipelined) {
+        if (m_pipelineWorker == nullptr) {
+            m_pipelineWorker = std::make_unique<RealtimeWorkerPool>(1);
+        }
+        m_pipelineInput.resize(m_spanSize);
+        m_pipelineInputSilent.assign(m_numMicroBlocksPerSpan, 1);
+        m_pipelineOutput.resize(m_spanSize);
+        m_latencyFifo.resize(m_spanSize * 2);
+        m_latencyFifo.clear();
+        m_latencyFifoReadPos = 0;
+        m_latencyFifoNumSamples = m_pipelineLatency; // one span of silence
+    }
 }
 
 void BasicSynthesizer::addParameterToLayout(juce::AudioProcessorValueTreeState::ParameterLayout& layout) {
@@ -39,12 +75,28 @@ void BasicSynthesizer::updateParameters(size_t numSamples) {
     m_fxChain.updateParameters(numSamples);
 }
 
-void BasicSynthesizer::prepareParameters(FType sampleRate, size_t numSamples) {
+void BasicSynthesizer::prepareParameters(FType sampleRate, size_t /*numSamples*/) {
+    ScopedBufferArena arenaScope{m_bufferArena};
+    const size_t numSamples = m_microBlockSize;
+
     m_polyOscillor.prepareParameters(sampleRate, numSamples);
     m_LFOModulationManager.prepareParameters(sampleRate, numSamples);
     m_EnvModulationManager.prepareParameters(sampleRate, numSamples);
-    m_filter.prepareParameters(sampleRate, numSamples);
-    m_fxChain.prepareParameters(sampleRate, numSamples);
+
+    // filter and fx chain run after the voices of a span,and on helper thread when pipelined,
+    // so they read the micro blocks of their parameters from the pipeline slots
+    m_pipelinedParameters.clear();
+    {
+        ScopedParameterCollector collector{m_pipelinedParameters};
+        m_filter.prepareParameters(sampleRate, numSamples);
+        m_fxChain.prepareParameters(sampleRate, numSamples);
+    }
+    for (auto* p : m_pipelinedParameters) {
+        p->setPipelined(true);
+        p->preparePipelineSlots(m_numMicroBlocksPerSpan);
+    }
+    m_fxChain.setPipelined(true);
+    m_fxChain.preparePipelineSlots(m_numMicroBlocksPerSpan);
 }
 
 void BasicSynthesizer::saveExtraState(juce::XmlElement& xml) {
@@ -71,6 +123,7 @@ void BasicSynthesizer::process(size_t beginSamplePos, size_t endSamplePos) {
     // Important.Modulators must first be processed.
     m_LFOModulationManager.process(beginSamplePos, endSamplePos);
     m_EnvModulationManager.process(beginSamplePos, endSamplePos);
+    m_modulationMatrix.process(beginSamplePos, endSamplePos);
 
     m_polyOscillor.process(beginSamplePos, endSamplePos);
 }
@@ -87,9 +140,12 @@ BasicSynthesizer::BasicSynthesizer(const juce::String& ID)
     m_EnvModulationManager.addModulator(std::make_unique<Envelop>("ENV2"));
     m_EnvModulationManager.addModulator(std::make_unique<Envelop>("ENV3"));
     m_EnvModulationManager.addModulator(std::make_unique<Envelop>("ENV4"));
+    m_LFOModulationManager.connectTo(m_modulationMatrix);
+    m_EnvModulationManager.connectTo(m_modulationMatrix);
+    m_polyOscillor.connectVoiceTargets(m_modulationMatrix);
 
-    // Filter init
-    m_filter.addAudioInput(&m_polyOscillor, m_polyOscillor.getOutputBuffer());
+    // Filter init,the oscillor's span is copied in one micro block at a time
+    m_filter.addAudioInput(&m_polyOscillor, &m_filterInput);
 
     // fx chain init
     m_fxChain.setAudioInput(m_filter.getFilterOutput());
@@ -97,36 +153,174 @@ BasicSynthesizer::BasicSynthesizer(const juce::String& ID)
 
 void BasicSynthesizer::processBlock(juce::MidiBuffer& midiBuffer,
                                     juce::AudioBuffer<FType>& audioBuffer) {
-    size_t totalNumSamples = audioBuffer.getNumSamples();
+    const size_t totalNumSamples = audioBuffer.getNumSamples();
+    auto midiEvent = midiBuffer.cbegin();
+    const auto midiEnd = midiBuffer.cend();
+
+    // Whole block in spans of micro blocks,so it may be larger than the size given to prepare
+    for (size_t spanOffset = 0; spanOffset < totalNumSamples; spanOffset += m_spanSize) {
+        const size_t spanNumSamples = juce::jmin(m_spanSize, totalNumSamples - spanOffset);
+        for (size_t index = 0; index * m_microBlockSize < spanNumSamples; index++) {
+            const size_t offset = spanOffset + index * m_microBlockSize;
+            const size_t numSamples = juce::jmin(m_microBlockSize, totalNumSamples - offset);
+            // events past the end of the host block belong to the last micro block
+            const bool isLast = offset + numSamples == totalNumSamples;
+            auto eventsEnd = midiEvent;
+            while (eventsEnd != midiEnd && (isLast || (*eventsEnd).samplePosition < static_cast<int>(offset + numSamples))) {
+                ++eventsEnd;
+            }
+            processMicroBlock(midiEvent, eventsEnd, offset, index, numSamples);
+            midiEvent = eventsEnd;
+        }
+        m_polyOscillor.renderSpan();
 
+        if (m_isPipelined) {
+            processPipelined(audioBuffer, spanOffset, spanNumSamples);
+        } else {
+            processSpan(audioBuffer, spanOffset, spanNumSamples);
+        }
+    }
+}
+
+void BasicSynthesizer::processMicroBlock(juce::MidiBufferIterator midiBegin, juce::MidiBufferIterator midiEnd,
+                                         size_t offset, size_t index, size_t numSamples) {
     // First generate all parameter's smooth values into buffer
-    updateParameters(totalNumSamples);
+    updateParameters(numSamples);
 
-    // Then handle midi event
+    // Then handle midi event,every range of the block is rendered exactly once
+    m_polyOscillor.beginMicroBlock(index);
+    const size_t minSlice = m_minSliceSamples.load(std::memory_order_relaxed);
     size_t currentSample = 0;
-    for (auto midiEvent : midiBuffer) {
+    for (auto it = midiBegin; it != midiEnd; ++it) {
+        const auto midiEvent = *it;
         auto midiMessage = midiEvent.getMessage();
+        const auto eventPos = static_cast<size_t>(juce::jmax(0, midiEvent.samplePosition));
+        const auto position = juce::jlimit<size_t>(currentSample, numSamples, eventPos > offset ? eventPos - offset : 0);
         /*
         *   if this midi event is too close to last midi event,no matter what it is,do not
-        * do render process,just handle it.
+        * do render process,just handle it.It moves to the start of the range.
         *   for others,you need render it first and then handle this midi event.
         */
-        process(currentSample, midiEvent.samplePosition);
-        handleMidiMessage(midiMessage, currentSample, midiEvent.samplePosition);
-        currentSample = midiEvent.samplePosition;
+        if (position > currentSample && position - currentSample >= minSlice) {
+            process(currentSample, position);
+            currentSample = position;
+        }
+        handleMidiMessage(midiMessage, currentSample, position);
     }
 
     // Process buffer between last message(or null event) and last sample position
-    process(currentSample, totalNumSamples);
+    process(currentSample, numSamples);
+
+    // filter and fx chain read this micro block after the span
+    for (auto* p : m_pipelinedParameters) {
+        p->storePipelineBlock(index);
+    }
+    m_fxChain.storePipelineBlock(index);
+}
 
+void BasicSynthesizer::processSpan(juce::AudioBuffer<FType>& audioBuffer, size_t offset, size_t numSamples) {
     // Directly let filter and effects chain work
-    m_filter.process(0, totalNumSamples);
-    m_fxChain.process(0, totalNumSamples);
+    swapPipelineBuffers();
+    const auto& oscOutput = *m_polyOscillor.getOutputBuffer();
+    for (size_t index = 0; index * m_microBlockSize < numSamples; index++) {
+        const size_t begin = index * m_microBlockSize;
+        const size_t num = juce::jmin(m_microBlockSize, numSamples - begin);
+        const auto& output = processFilterAndEffects(oscOutput, m_polyOscillor.isMicroBlockSilent(index), index, num);
+
+        // Copy to output
+        copyToOutput(output, 0, audioBuffer, offset + begin, num);
+    }
+}
+
+const StereoBuffer& BasicSynthesizer::processFilterAndEffects(const StereoBuffer& input, bool isInputSilent,
+                                                              size_t index, size_t numSamples) {
+    const size_t begin = index * m_microBlockSize;
+    juce::FloatVectorOperations::copy(m_filterInput.left.data(), input.left.data() + begin, (int)numSamples);
+    juce::FloatVectorOperations::copy(m_filterInput.right.data(), input.right.data() + begin, (int)numSamples);
+    m_filterInput.isMono = input.isMono;
+    m_filterInput.isSilent = isInputSilent;
+
+    for (auto* p : m_pipelinedParameters) {
+        p->setPipelineReadSlot(index);
+    }
+    m_fxChain.setPipelineReadSlot(index);
+    m_filter.process(0, numSamples);
+    m_fxChain.process(0, numSamples);
+    return *m_fxChain.getChainOutput();
+}
+
+void BasicSynthesizer::swapPipelineBuffers() {
+    for (auto* p : m_pipelinedParameters) {
+        p->swapPipelineBuffers();
+    }
+    m_fxChain.swapPipelineBuffers();
+}
+
+void BasicSynthesizer::copyToOutput(const StereoBuffer& buffer, size_t bufferPos,
+                                    juce::AudioBuffer<FType>& audioBuffer, size_t offset, size_t numSamples) {
+    // a mono output bus gets the left channel
+    for (int channel = 0; channel < juce::jmin(2, audioBuffer.getNumChannels()); channel++) {
+        const auto& source = channel == 0 ? buffer.left : buffer.right;
+        audioBuffer.copyFrom(channel, (int)offset, source.data() + bufferPos, (int)numSamples);
+    }
+}
+
+void BasicSynthesizer::processPipelined(juce::AudioBuffer<FType>& audioBuffer, size_t offset, size_t numSamples) {
+    // Collect last span from helper thread
+    m_pipelineWorker->wait();
+    if (m_pipelineNumSamples != 0) {
+        pushToLatencyFifo(m_pipelineOutput, m_pipelineNumSamples);
+    }
+
+    // Hand this span over,parameters are already smoothed and modulated
+    swapPipelineBuffers();
+    const auto& oscOutput = *m_polyOscillor.getOutputBuffer();
+    juce::FloatVectorOperations::copy(m_pipelineInput.left.data(), oscOutput.left.data(), (int)numSamples);
+    juce::FloatVectorOperations::copy(m_pipelineInput.right.data(), oscOutput.right.data(), (int)numSamples);
+    m_pipelineInput.isMono = oscOutput.isMono;
+    for (size_t index = 0; index < m_numMicroBlocksPerSpan; index++) {
+        m_pipelineInputSilent[index] = m_polyOscillor.isMicroBlockSilent(index) ? 1 : 0;
+    }
+    m_pipelineNumSamples = numSamples;
+    m_pipelineWorker->start(*this, 1);
+
+    pullFromLatencyFifo(audioBuffer, offset, numSamples);
+}
+
+void BasicSynthesizer::runJob(size_t /*jobIndex*/) {
+    // the micro blocks of the span one after another,like processSpan
+    for (size_t index = 0; index * m_microBlockSize < m_pipelineNumSamples; index++) {
+        const size_t begin = index * m_microBlockSize;
+        const size_t num = juce::jmin(m_microBlockSize, m_pipelineNumSamples - begin);
+        const auto& output = processFilterAndEffects(m_pipelineInput, m_pipelineInputSilent[index] != 0, index, num);
+        juce::FloatVectorOperations::copy(m_pipelineOutput.left.data() + begin, output.left.data(), (int)num);
+        juce::FloatVectorOperations::copy(m_pipelineOutput.right.data() + begin, output.right.data(), (int)num);
+    }
+}
+
+void BasicSynthesizer::pushToLatencyFifo(const StereoBuffer& buffer, size_t numSamples) {
+    const size_t fifoSize = m_latencyFifo.left.size();
+    jassert(m_latencyFifoNumSamples + numSamples <= fifoSize);
+
+    size_t writePos = (m_latencyFifoReadPos + m_latencyFifoNumSamples) % fifoSize;
+    size_t firstPart = juce::jmin(numSamples, fifoSize - writePos);
+    juce::FloatVectorOperations::copy(m_latencyFifo.left.data() + writePos, buffer.left.data(), (int)firstPart);
+    juce::FloatVectorOperations::copy(m_latencyFifo.right.data() + writePos, buffer.right.data(), (int)firstPart);
+    juce::FloatVectorOperations::copy(m_latencyFifo.left.data(), buffer.left.data() + firstPart, (int)(numSamples - firstPart));
+    juce::FloatVectorOperations::copy(m_latencyFifo.right.data(), buffer.right.data() + firstPart, (int)(numSamples - firstPart));
+    m_latencyFifoNumSamples += numSamples;
+}
+
+void BasicSynthesizer::pullFromLatencyFifo(juce::AudioBuffer<FType>& audioBuffer, size_t offset, size_t numSamples) {
+    const size_t fifoSize = m_latencyFifo.left.size();
+    // always holds m_pipelineLatency samples here,which is the span size
+    jassert(numSamples <= m_latencyFifoNumSamples);
 
-    // Copy to output
-    auto* out = m_fxChain.getChainOutput();
-    audioBuffer.copyFrom(0, 0, out->left.data(), (int)totalNumSamples);
-    audioBuffer.copyFrom(1, 0, out->right.data(), (int)totalNumSamples);
+    size_t firstPart = juce::jmin(numSamples, fifoSize - m_latencyFifoReadPos);
+    copyToOutput(m_latencyFifo, m_latencyFifoReadPos, audioBuffer, offset, firstPart);
+    copyToOutput(m_latencyFifo, 0, audioBuffer, offset + firstPart, numSamples - firstPart);
+    m_latencyFifoReadPos = (m_latencyFifoReadPos + numSamples) % fifoSize;
+    m_latencyFifoNumSamples -= numSamples;
 }
 
 void BasicSynthesizer::handleMidiMessage(const juce::MidiMessage& message,
@@ -17,30 +17,76 @@
 
 #include "AudioProcessorBase.h"
 #include "modulation/ModulationManager.h"
+#include "modulation/ModulationMatrix.h"
 #include "Oscillor/PolyOscillor.h"
 #include "Filter/MainFilter.h"
 #include "Effects/OrderableEffectsChain.h"
+#include "utils/RealtimeWorkerPool.h"
 
 namespace rpSynth::audio {
 class PolyOscillor;
 }
 
 namespace rpSynth::audio {
-class BasicSynthesizer : public AudioProcessorBase {
+class BasicSynthesizer : public AudioProcessorBase, private RealtimeWorkerPool::Job {
 public:
     BasicSynthesizer(const juce::String& ID);
     ~BasicSynthesizer() override = default;
     /**
-     * @brief get the total audio block,call it on juce audio thread's processBlock method
+     * @brief get the total audio block,call it on juce audio thread's processBlock method.
+     *        It is processed in micro blocks,so any block size is fine.
      * @param midiBuffer the total midi buffer
      * @param audioBuffer the total audio buffer
     */
     void processBlock(juce::MidiBuffer& midiInputBuffer, juce::AudioBuffer<FType>& audioOutputBuffer);
 
+    /**
+     * @brief Samples processed at once inside processBlock,parameter,modulation and stage
+     *        buffers hold this many.Takes effect on next prepare,which uses the host block
+     *        size instead when that is smaller.The oscillor renders the micro blocks of a
+     *        host block together,and filter and fx chain take them over once per host block.
+    */
+    void setMicroBlockSize(size_t numSamples) {
+        m_microBlockSizeRequested = juce::jlimit(kMinMicroBlockSize, kMaxMicroBlockSize, numSamples);
+    }
+    size_t getMicroBlockSize() const { return m_microBlockSize; }
+
+    /**
+     * @brief Midi events closer than this to the start of the range being collected are
+     *        handled at its start,so dense midi does not split a block into tiny ranges.
+     *        Such events move earlier by up to numSamples - 1 samples.Default 0 renders
+     *        every event at its own sample.
+    */
+    void setMinimumSliceSamples(size_t numSamples) { m_minSliceSamples = numSamples; }
+    size_t getMinimumSliceSamples() const { return m_minSliceSamples; }
+
+    /**
+     * @brief Run filter and fx chain of a span on a helper thread while the next span's
+     *        voices render.A span is the host block size given to prepare,rounded up to
+     *        whole micro blocks.Adds one span of latency,takes effect on next prepare.
+    */
+    void setPipelinedProcessing(bool shouldPipeline) { m_pipelineRequested = shouldPipeline; }
+    bool isPipelinedProcessing() const { return m_isPipelined; }
+
+    /**
+     * @brief Latency of pipelining and filter oversampling,report it to the host.
+     *        The oversampling part follows the parameter,so it may change between blocks.
+    */
+    size_t getLatencySamples() const { return (m_isPipelined ? m_pipelineLatency : 0) + m_filter.getLatencySamples(); }
+
+    /**
+     * @brief How long the output rings after the last voice stopped,from the current settings
+    */
+    double getTailLengthSeconds() const {
+        return static_cast<double>(SilenceTracker::kHoldTimeInSeconds) + m_fxChain.getTailLengthSeconds();
+    }
+
     // implement from AudioProcessorBase
     void addParameterToLayout(juce::AudioProcessorValueTreeState::ParameterLayout& layout) override;
     void updateParameters(size_t numSamples) override;
+    // numSamples is ignored,parameters are prepared for the micro block size of prepare
     void prepareParameters(FType sampleRate, size_t numSamples) override;
+    // call prepareParameters after prepare,both share one arena
     void prepare(FType sampleRate, size_t numSamlpes) override;
     void process(size_t beginSamplePos, size_t endSamplePos) override;
     void saveExtraState(juce::XmlElement& xml) override;
@@ -55,6 +101,27 @@ private:
     */
     void handleMidiMessage(const juce::MidiMessage& message, size_t lastPosition, size_t position);
 
+    /**
+     * @brief Parameters,modulation and voices of [offset,offset + numSamples) of the host
+     *        block,micro block index of the span.Midi positions are still relative to the host block
+    */
+    void processMicroBlock(juce::MidiBufferIterator midiBegin, juce::MidiBufferIterator midiEnd,
+                           size_t offset, size_t index, size_t numSamples);
+
+    // filter and fx chain of a rendered span,micro block by micro block
+    void processSpan(juce::AudioBuffer<FType>& audioBuffer, size_t offset, size_t numSamples);
+    const StereoBuffer& processFilterAndEffects(const StereoBuffer& input, bool isInputSilent,
+                                                size_t index, size_t numSamples);
+    void swapPipelineBuffers();
+    static void copyToOutput(const StereoBuffer& buffer, size_t bufferPos,
+                             juce::AudioBuffer<FType>& audioBuffer, size_t offset, size_t numSamples);
+
+    // pipelined filter and fx chain
+    void processPipelined(juce::AudioBuffer<FType>& audioBuffer, size_t offset, size_t numSamples);
+    void runJob(size_t jobIndex) override;
+    void pushToLatencyFifo(const StereoBuffer& buffer, size_t numSamples);
+    void pullFromLatencyFifo(juce::AudioBuffer<FType>& audioBuffer, size_t offset, size_t numSamples);
+
 public:
     // poly oscillor
     PolyOscillor m_polyOscillor{"OSC1"};
@@ -68,6 +135,51 @@ public:
     // modulation
     ModulationManager m_LFOModulationManager{"LFOMODULATORS"};
     ModulationManager m_EnvModulationManager{"ENVMODULATORS"};
+    ModulationMatrix m_modulationMatrix;
+
+private:
+    // parameter,modulator and audio buffers of every processor,refilled on prepare
+    BufferArena m_bufferArena;
+
+    // sub-block scheduling,see setMinimumSliceSamples
+    static constexpr size_t kDefaultMinSliceSamples = 0;
+    std::atomic<size_t> m_minSliceSamples = kDefaultMinSliceSamples;
+
+    // micro blocks,see setMicroBlockSize
+    static constexpr size_t kMinMicroBlockSize = 16;
+    static constexpr size_t kMaxMicroBlockSize = 1024;
+    static constexpr size_t kDefaultMicroBlockSize = 64;
+    std::atomic<size_t> m_microBlockSizeRequested = kDefaultMicroBlockSize;
+    size_t m_microBlockSize = kDefaultMicroBlockSize;
+    size_t m_numMicroBlocksPerSpan = 1;
+    size_t m_spanSize = kDefaultMicroBlockSize;
+
+    // one micro block of the oscillor's span,the filter's input
+    StereoBuffer m_filterInput;
+
+    //=========================================================================
+    // pipeline
+    std::atomic<bool> m_pipelineRequested = false;
+    bool m_isPipelined = false;
+    size_t m_pipelineLatency = 0;
+
+    // filter and fx parameters,one slot per micro block of a span
+    std::vector<MyAudioProcessParameter*> m_pipelinedParameters;
+
+    // oscillor output of the span on the helper thread,and what the chain made of it
+    StereoBuffer m_pipelineInput;
+    std::vector<uint8_t> m_pipelineInputSilent;
+    StereoBuffer m_pipelineOutput;
+    size_t m_pipelineNumSamples = 0;
+
+    // keeps latency at exactly m_pipelineLatency when a span is shorter
+    StereoBuffer m_latencyFifo;
+    size_t m_latencyFifoReadPos = 0;
+    size_t m_latencyFifoNumSamples = 0;
+
+    // declared last,so it stops before the processors it runs are destroyed
+    std::unique_ptr<RealtimeWorkerPool> m_pipelineWorker;
+    //=========================================================================
 };
 }
 
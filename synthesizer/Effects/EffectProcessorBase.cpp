@@ -18,7 +18,51 @@ rpSynth::audio::effects::EffectProcessorBase::EffectProcessorBase(OrderableEffec
 }
 
 void rpSynth::audio::effects::EffectProcessorBase::process(size_t beginSamplePos, size_t endSamplePos){ 
-    if (notBypass->get()) {
-        processBlock(*chain.getChainOutput(), beginSamplePos, endSamplePos);
+    const auto& fade = getFadeState();
+    if (!fade.isActive()) return;
+
+    // asleep,silence in is silence out
+    auto& buffer = *chain.getChainOutput();
+    const bool isInputSilent = buffer.isSilent;
+    if (m_silence.canSkip(isInputSilent)) return;
+
+    // effects are the first truly stereo stage
+    buffer.isMono = false;
+    buffer.isSilent = false;
+    if (fade.isFullyOn()) {
+        processBlock(buffer, beginSamplePos, endSamplePos);
+        if (m_silence.update(isInputSilent, buffer, beginSamplePos, endSamplePos)) reset();
+        return;
+    }
+
+    // fading,out = dry + (wet - dry) * gain
+    auto& dry = chain.getDryBuffer();
+    const auto numSamples = endSamplePos - beginSamplePos;
+    juce::FloatVectorOperations::copy(dry.left.data() + beginSamplePos, buffer.left.data() + beginSamplePos, (int)numSamples);
+    juce::FloatVectorOperations::copy(dry.right.data() + beginSamplePos, buffer.right.data() + beginSamplePos, (int)numSamples);
+    processBlock(buffer, beginSamplePos, endSamplePos);
+
+    const FType step = (fade.endGain - fade.startGain) / static_cast<FType>(numSamples);
+    for (size_t i = beginSamplePos; i < endSamplePos; i++) {
+        const FType gain = fade.startGain + step * static_cast<FType>(i - beginSamplePos + 1);
+        buffer.left[i] = dry.left[i] + (buffer.left[i] - dry.left[i]) * gain;
+        buffer.right[i] = dry.right[i] + (buffer.right[i] - dry.right[i]) * gain;
     }
+    if (m_silence.update(isInputSilent, buffer, beginSamplePos, endSamplePos)) reset();
+
+    // faded out,drop the delay and feedback state so re-enabling starts clean
+    if (fade.endGain == FType{}) reset();
+}
+
+bool rpSynth::audio::effects::EffectProcessorBase::updateFade(FType maxGainStep) {
+    const FType target = notBypass->get() ? FType{1} : FType{};
+    const FType startGain = m_gain;
+    m_gain += juce::jlimit(-maxGainStep, maxGainStep, target - m_gain);
+    m_fade = FadeState{startGain, m_gain};
+    return m_fade.isActive();
+}
+
+void rpSynth::audio::effects::EffectProcessorBase::snapFade() {
+    m_gain = notBypass->get() ? FType{1} : FType{};
+    m_fade = FadeState{m_gain, m_gain};
 }
@@ -12,7 +12,10 @@
 #include <JuceHeader.h>
 
 #include "synthesizer/AudioProcessorBase.h"
+#include "synthesizer/utils/SilenceTracker.h"
+#if ! RPSYNTH_HEADLESS
 #include "ui/ContainModulableComponent.h"
+#endif
 
 namespace rpSynth::audio {
 class OrderableEffectsChain;
@@ -21,19 +24,89 @@ class OrderableEffectsChain;
 namespace rpSynth::audio::effects {
 class EffectProcessorBase : public AudioProcessorBase {
 public:
+    // fade in and out when enabled or disabled,so toggling does not click
+    static constexpr FType kFadeTimeInSeconds = static_cast<FType>(0.01);
+
+    // wet gain of one block,ramps from startGain to endGain
+    struct FadeState {
+        FType startGain{};
+        FType endGain{};
+
+        bool isActive() const { return startGain > FType{} || endGain > FType{}; }
+        bool isFullyOn() const { return startGain == FType{1} && endGain == FType{1}; }
+    };
+
     EffectProcessorBase(OrderableEffectsChain& c, const juce::String& ID);
     virtual ~EffectProcessorBase() = default;
     virtual void processBlock(StereoBuffer& block, size_t begin, size_t end) = 0;
+#if ! RPSYNTH_HEADLESS
     virtual std::unique_ptr<ui::ContainModulableComponent> createEffectPanel() = 0;
+#endif
 
     void process(size_t beginSamplePos, size_t endSamplePos) override;
     virtual void addParameterToLayout(juce::AudioProcessorValueTreeState::ParameterLayout& layout) override;
     const juce::String& getEffectName() const { return m_effectName; }
+
+    //================================================================================
+    // Sleeping while the input is silent and the effect rang out
+
+    /**
+     * @brief Clear delay lines and filters,called when the effect falls asleep
+    */
+    virtual void reset() {}
+
+    /**
+     * @brief Seconds until the effect rings out after its input stops,from the current settings
+    */
+    virtual double getTailLengthSeconds() const { return 0.0; }
+
+    void prepareSilenceTracking(FType sampleRate) { m_silence.prepare(sampleRate); }
+    bool isSleeping() const { return m_silence.isSleeping(); }
+    //================================================================================
+
+    //================================================================================
+    // Enable fading,works like the pipelining of MyAudioProcessParameter
+
+    /**
+     * @brief Latch notBypass for the next block and move the fade,call it where
+     *        parameters are updated
+     * @param maxGainStep How far the gain may move in this block
+     * @return False when the effect is off for the whole block,its parameters and
+     *         state can stay frozen
+    */
+    bool updateFade(FType maxGainStep);
+
+    /**
+     * @brief Jump the fade to the current notBypass,so enabled effects start at
+     *        full gain after loading or prepare instead of fading in
+    */
+    void snapFade();
+
+    const FadeState& getFadeState() const { return m_isPipelined ? m_pipelineReadFades[m_pipelineReadSlot] : m_fade; }
+    void setPipelined(bool shouldBePipelined) { m_isPipelined = shouldBePipelined; }
+    void preparePipelineSlots(size_t numSlots) {
+        m_pipelineWriteFades.assign(numSlots, m_fade);
+        m_pipelineReadFades.assign(numSlots, m_fade);
+        m_pipelineReadSlot = 0;
+    }
+    void storePipelineBlock(size_t slot) { m_pipelineWriteFades[slot] = m_fade; }
+    void swapPipelineBuffers() { std::swap(m_pipelineWriteFades, m_pipelineReadFades); }
+    void setPipelineReadSlot(size_t slot) { m_pipelineReadSlot = slot; }
+    //================================================================================
 public:
     juce::AudioParameterBool* notBypass;
 private:
     OrderableEffectsChain& chain;
     juce::String m_effectName;
+
+    FType m_gain{};
+    FadeState m_fade;
+    std::vector<FadeState> m_pipelineWriteFades;
+    std::vector<FadeState> m_pipelineReadFades;
+    size_t m_pipelineReadSlot = 0;
+    bool m_isPipelined = false;
+
+    SilenceTracker m_silence;
 };
 
 inline void EffectProcessorBase::addParameterToLayout(juce::AudioProcessorValueTreeState::ParameterLayout& layout) {
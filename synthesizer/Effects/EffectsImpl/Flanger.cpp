@@ -12,7 +12,9 @@
 #include "synthesizer/WrapParameter.h"
 #include "dsps/IIRHilbertTransform.h"
 
+#if ! RPSYNTH_HEADLESS
 #include "ui/controller/FloatKnob.h"
+#endif
 
 //================================================================================
 // ȫĲ
@@ -65,6 +67,7 @@ struct FlangerParameters {
     }
 };
 
+#if ! RPSYNTH_HEADLESS
 //================================================================================
 // Flanger Panel
 //================================================================================
@@ -164,6 +167,7 @@ private:
     juce::ToggleButton m_disableBarber;
     juce::ButtonParameterAttachment m_attach;
 };
+#endif
 
 //================================================================================
 // Flanger Impl
@@ -239,6 +243,14 @@ public:
         FType m_phase{};
     };
 
+    // per sample parameters of one block,indexed like the buffer
+    struct ParameterBlocks {
+        const FType* feedback;
+        const FType* mix;
+        const FType* barberpoleRate;
+        const FType* barberpolePhase;
+    };
+
     FlangerImpl(FlangerParameters& e) :p(e) {};
     void prepare(FType sr, size_t num) {
         m_srDiv1000 = sr / FType{1000};
@@ -265,6 +277,29 @@ public:
         m_leftBarberpoleLFO.prepare(sr);
         m_rightBarberpoleLFO.prepare(sr);
         m_mainDelayLFO.prepare(sr);
+
+        m_feedbackBuffer.resize(num);
+        m_mixBuffer.resize(num);
+        m_barberpoleRateBuffer.resize(num);
+        m_barberpolePhaseBuffer.resize(num);
+    }
+
+    void reset() {
+        m_delayLine.reset();
+        m_TZFdelayLine.reset();
+        fbLF.reset();
+        fbHF.reset();
+        hilbertL.reset();
+        hilbertR.reset();
+        m_fbValue = {};
+    }
+
+    // feedback goes around the longest delay
+    double getTailLengthSeconds() const {
+        const double loopSeconds = (p.delayTime.getHostParameter()->range.end
+                                    + p.depth.getHostParameter()->range.end
+                                    + p.TZFDelayTime.getHostParameter()->range.end) / 1000.0;
+        return SilenceTracker::feedbackTailSeconds(loopSeconds, p.feedback.getHostParameter()->get());
     }
 
     void process(StereoBuffer& buffer, size_t begin, size_t end) {
@@ -282,12 +317,30 @@ public:
         setDelayTime<0>(lDelay, tzfDelayInSample);
         setDelayTime<1>(rDelay, tzfDelayInSample);
 
+        // per sample parameters,read once when none of them moves in this block
+        const bool isConstant = p.feedback.isConstant() && p.mix.isConstant()
+            && p.barberpoleRate.isConstant() && p.barberpolePhase.isConstant();
+        const ParameterBlocks blocks{
+            p.feedback.getBlock(begin, end, m_feedbackBuffer.data()),
+            p.mix.getBlock(begin, end, m_mixBuffer.data()),
+            p.barberpoleRate.getBlock(begin, end, m_barberpoleRateBuffer.data()),
+            p.barberpolePhase.getBlock(begin, end, m_barberpolePhaseBuffer.data())
+        };
+        if (isConstant) {
+            processChannels<true>(buffer, blocks, begin, end);
+        } else {
+            processChannels<false>(buffer, blocks, begin, end);
+        }
+    }
+
+    template<bool isConstant>
+    void processChannels(StereoBuffer& buffer, const ParameterBlocks& blocks, size_t begin, size_t end) {
         if (p.disableBarberpole->get()) {
-            processChannelWithoutHilbert<0>(buffer.left, begin, end);
-            processChannelWithoutHilbert<1>(buffer.right, begin, end);
+            processChannelWithoutHilbert<0, isConstant>(buffer.left, blocks, begin, end);
+            processChannelWithoutHilbert<1, isConstant>(buffer.right, blocks, begin, end);
         } else {
-            processChannel<0>(buffer.left, begin, end);
-            processChannel<1>(buffer.right, begin, end);
+            processChannel<0, isConstant>(buffer.left, blocks, begin, end);
+            processChannel<1, isConstant>(buffer.right, blocks, begin, end);
         }
     }
 
@@ -301,11 +354,19 @@ public:
     // |      LFO        LFO          Feedback---+
     // +---------------------------------+
     //================================================================================
-    template<size_t channel>
-    void processChannel(std::vector<FType>& data, size_t begin, size_t end) {
+    template<size_t channel, bool isConstant>
+    void processChannel(SampleBuffer& data, const ParameterBlocks& blocks, size_t begin, size_t end) {
+        const FType constantFeedback = blocks.feedback[begin];
+        const FType constantMix = blocks.mix[begin];
+        const FType constantBarberpoleRate = blocks.barberpoleRate[begin];
+        const FType constantBarberpolePhase = blocks.barberpolePhase[begin];
         for (size_t i = begin; i < end; i++) {
+            const FType feedback = isConstant ? constantFeedback : blocks.feedback[i];
+            const FType mix = isConstant ? constantMix : blocks.mix[i];
+            const FType barberpoleRate = isConstant ? constantBarberpoleRate : blocks.barberpoleRate[i];
+            const FType barberpolePhase = isConstant ? constantBarberpolePhase : blocks.barberpolePhase[i];
             FType sample = data[i];
-            auto fbVal = juce::jlimit(FType{-0.9}, FType{0.9}, p.feedback.get(i)) 
+            auto fbVal = juce::jlimit(FType{-0.9}, FType{0.9}, feedback) 
                 * getFeedback<channel>();
             m_TZFdelayLine.pushSample(channel, sample);
             FType tzfout = m_TZFdelayLine.popSample(channel, getTZFDelayTime<channel>());
@@ -313,9 +374,9 @@ public:
             auto delayout = m_delayLine.popSample(channel, getDelayTime<channel>());
 
             FPolyType hilbertMid = hilbert<channel>(delayout);
-            auto sincos = getBarberLFO<channel>(p.barberpoleRate.get(i), p.barberpolePhase.get(i));
+            auto sincos = getBarberLFO<channel>(barberpoleRate, barberpolePhase);
             auto hilbertOut = sincos.right * hilbertMid.left + sincos.left * hilbertMid.right;
-            auto mixout = tzfout + p.mix.get(i) * hilbertOut + fbVal;
+            auto mixout = tzfout + mix * hilbertOut + fbVal;
 
             fbUpdate<channel>(hilbertOut);
             data[i] = mixout;
@@ -332,17 +393,21 @@ public:
     // |      LFO                    Feedback
     // +---------------------------------+
     //================================================================================
-    template<size_t channel>
-    void processChannelWithoutHilbert(std::vector<FType>& data, size_t begin, size_t end) {
+    template<size_t channel, bool isConstant>
+    void processChannelWithoutHilbert(SampleBuffer& data, const ParameterBlocks& blocks, size_t begin, size_t end) {
+        const FType constantFeedback = blocks.feedback[begin];
+        const FType constantMix = blocks.mix[begin];
         for (size_t i = begin; i < end; i++) {
+            const FType feedback = isConstant ? constantFeedback : blocks.feedback[i];
+            const FType mix = isConstant ? constantMix : blocks.mix[i];
             FType sample = data[i];
             m_TZFdelayLine.pushSample(channel, sample);
             FType tzfout = m_TZFdelayLine.popSample(channel, getTZFDelayTime<channel>());
 
-            auto withFb = sample + p.feedback.get(i) * getFeedback<channel>();
+            auto withFb = sample + feedback * getFeedback<channel>();
             m_delayLine.pushSample(channel, withFb);
             auto delayout = m_delayLine.popSample(channel, getDelayTime<channel>());
-            auto mixout = tzfout + p.mix.get(i) * delayout;
+            auto mixout = tzfout + mix * delayout;
 
             fbUpdate<channel>(delayout);
             data[i] = mixout;
@@ -432,6 +497,10 @@ private:
     FlangerParameters& p;
     FType m_srDiv1000{};
     FPolyType m_fbValue{};
+    SampleBuffer m_feedbackBuffer;
+    SampleBuffer m_mixBuffer;
+    SampleBuffer m_barberpoleRateBuffer;
+    SampleBuffer m_barberpolePhaseBuffer;
     juce::dsp::DelayLine<FType> m_delayLine;
     juce::dsp::DelayLine<FType> m_TZFdelayLine;
     juce::dsp::FirstOrderTPTFilter<FType> fbLF;
@@ -550,7 +619,17 @@ void Flanger::processBlock(StereoBuffer& block, size_t begin, size_t end) {
     m_flangerImpl->process(block, begin, end);
 }
 
+void Flanger::reset() {
+    m_flangerImpl->reset();
+}
+
+double Flanger::getTailLengthSeconds() const {
+    return m_flangerImpl->getTailLengthSeconds();
+}
+
+#if ! RPSYNTH_HEADLESS
 std::unique_ptr<ui::ContainModulableComponent> Flanger::createEffectPanel() {
     return std::make_unique<FlangerPanel>(*m_allFlangerParameters);
 }
+#endif
 }
\ No newline at end of file
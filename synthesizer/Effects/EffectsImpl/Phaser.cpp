@@ -13,7 +13,9 @@
 #include "dsps/AllPassFilter.h"
 #include "dsps/IIRHilbertTransform.h"
 
+#if ! RPSYNTH_HEADLESS
 #include "ui/controller/FloatKnob.h"
+#endif
 
 //================================================================================
 // ȫĲ
@@ -69,6 +71,7 @@ struct PhaserParameters {
     }
 };
 
+#if ! RPSYNTH_HEADLESS
 //================================================================================
 // Flanger Panel
 //================================================================================
@@ -172,6 +175,7 @@ private:
     juce::ToggleButton m_disableBarber;
     juce::ButtonParameterAttachment m_attach;
 };
+#endif
 
 //================================================================================
 // Flanger Impl
@@ -248,6 +252,14 @@ public:
         FType m_phase{};
     };
 
+    // per sample parameters of one block,indexed like the buffer
+    struct ParameterBlocks {
+        const FType* feedback;
+        const FType* mix;
+        const FType* barberpoleRate;
+        const FType* barberpolePhase;
+    };
+
     PhaserImpl(PhaserParameters& e) :p(e) {};
     void prepare(FType sr, size_t num) {
         m_sampleRate = sr;
@@ -265,6 +277,31 @@ public:
         m_leftBarberpoleLFO.prepare(sr);
         m_rightBarberpoleLFO.prepare(sr);
         m_mainDelayLFO.prepare(sr);
+
+        m_feedbackBuffer.resize(num);
+        m_mixBuffer.resize(num);
+        m_barberpoleRateBuffer.resize(num);
+        m_barberpolePhaseBuffer.resize(num);
+    }
+
+    void reset() {
+        fbLF.reset();
+        fbHF.reset();
+        for (auto& apf : m_APFArray) {
+            apf.reset();
+        }
+        hilbertL.reset();
+        hilbertR.reset();
+        m_fbValue = {};
+    }
+
+    // rough,feedback goes through every allpass,each delays about 1/(2pi f) at the lowest frequency
+    double getTailLengthSeconds() const {
+        const double lowestHertz = rpSynth::semitoneToHertz(static_cast<double>(
+            juce::jmin(p.beginSemitone.getHostParameter()->get(), p.endSemitone.getHostParameter()->get())));
+        const double numStates = juce::jmax(1.0, static_cast<double>(p.phaserState.getHostParameter()->get()));
+        const double loopSeconds = numStates / (juce::MathConstants<double>::twoPi * lowestHertz);
+        return SilenceTracker::feedbackTailSeconds(loopSeconds, p.feedback.getHostParameter()->get());
     }
 
     void process(StereoBuffer& buffer, size_t begin, size_t end) {
@@ -273,8 +310,8 @@ public:
         fbHF.setCutoffFrequency(p.fbHighCut.get(begin));
 
         // apf cutoff and quality
-        FType beginHertz = semitoneToHertz(p.beginSemitone.get(begin));
-        FType endHertz = semitoneToHertz(p.endSemitone.get(begin));
+        FType beginHertz = kernels::semitoneToHertz(p.beginSemitone.get(begin));
+        FType endHertz = kernels::semitoneToHertz(p.endSemitone.get(begin));
         FPolyType LRPhase = m_mainDelayLFO.CRTick(p.rate.get(begin), end - begin, p.lfoPhase.get(begin), p.lfoShape.get(begin));
         FType lHertz = juce::jmap(LRPhase.left, FType{-1}, FType{1}, beginHertz, endHertz);
         FType rHertz = juce::jmap(LRPhase.right, FType{-1}, FType{1}, beginHertz, endHertz);
@@ -285,12 +322,30 @@ public:
         m_APFCoeffects[1].setBandWidth(spread, m_sampleRate);
         int numState = static_cast<int>(p.phaserState.get(begin));
         
+        // per sample parameters,read once when none of them moves in this block
+        const bool isConstant = p.feedback.isConstant() && p.mix.isConstant()
+            && p.barberpoleRate.isConstant() && p.barberpolePhase.isConstant();
+        const ParameterBlocks blocks{
+            p.feedback.getBlock(begin, end, m_feedbackBuffer.data()),
+            p.mix.getBlock(begin, end, m_mixBuffer.data()),
+            p.barberpoleRate.getBlock(begin, end, m_barberpoleRateBuffer.data()),
+            p.barberpolePhase.getBlock(begin, end, m_barberpolePhaseBuffer.data())
+        };
+        if (isConstant) {
+            processChannels<true>(buffer, blocks, begin, end, numState);
+        } else {
+            processChannels<false>(buffer, blocks, begin, end, numState);
+        }
+    }
+
+    template<bool isConstant>
+    void processChannels(StereoBuffer& buffer, const ParameterBlocks& blocks, size_t begin, size_t end,int state) {
         if (p.disableBarberpole->get()) {
-            processChannelWithoutHilbert<0>(buffer.left, begin, end, numState);
-            processChannelWithoutHilbert<1>(buffer.right, begin, end, numState);
+            processChannelWithoutHilbert<0, isConstant>(buffer.left, blocks, begin, end, state);
+            processChannelWithoutHilbert<1, isConstant>(buffer.right, blocks, begin, end, state);
         } else {
-            processChannel<0>(buffer.left, begin, end, numState);
-            processChannel<1>(buffer.right, begin, end, numState);
+            processChannel<0, isConstant>(buffer.left, blocks, begin, end, state);
+            processChannel<1, isConstant>(buffer.right, blocks, begin, end, state);
         }
     }
 
@@ -304,11 +359,19 @@ public:
     // |      LFO        LFO          Feedback
     // +---------------------------------+
     //================================================================================
-    template<size_t channel>
-    void processChannel(std::vector<FType>& data, size_t begin, size_t end,int state) {
+    template<size_t channel, bool isConstant>
+    void processChannel(SampleBuffer& data, const ParameterBlocks& blocks, size_t begin, size_t end,int state) {
+        const FType constantFeedback = blocks.feedback[begin];
+        const FType constantMix = blocks.mix[begin];
+        const FType constantBarberpoleRate = blocks.barberpoleRate[begin];
+        const FType constantBarberpolePhase = blocks.barberpolePhase[begin];
         for (size_t i = begin; i < end; i++) {
+            const FType feedback = isConstant ? constantFeedback : blocks.feedback[i];
+            const FType mix = isConstant ? constantMix : blocks.mix[i];
+            const FType barberpoleRate = isConstant ? constantBarberpoleRate : blocks.barberpoleRate[i];
+            const FType barberpolePhase = isConstant ? constantBarberpolePhase : blocks.barberpolePhase[i];
             FType sample = data[i];
-            auto fbVal = juce::jlimit(FType{-0.9}, FType{0.9}, p.feedback.get(i))
+            auto fbVal = juce::jlimit(FType{-0.9}, FType{0.9}, feedback)
                 * getFeedback<channel>();
             auto input = sample + fbVal;
             for (int j = 0; j < state; j++) {
@@ -316,9 +379,9 @@ public:
             }
 
             FPolyType hilbertMid = hilbert<channel>(input);
-            auto sincos = getBarberLFO<channel>(p.barberpoleRate.get(i), p.barberpolePhase.get(i));
+            auto sincos = getBarberLFO<channel>(barberpoleRate, barberpolePhase);
             auto hilbertOut = sincos.right * hilbertMid.left + sincos.left * hilbertMid.right;
-            auto mixout = sample + p.mix.get(i) * hilbertOut + fbVal;
+            auto mixout = sample + mix * hilbertOut + fbVal;
 
             fbUpdate<channel>(hilbertOut);
             data[i] = mixout;
@@ -335,15 +398,19 @@ public:
     // |      LFO                    Feedback
     // +---------------------------------+
     //================================================================================
-    template<size_t channel>
-    void processChannelWithoutHilbert(std::vector<FType>& data, size_t begin, size_t end,int state) {
+    template<size_t channel, bool isConstant>
+    void processChannelWithoutHilbert(SampleBuffer& data, const ParameterBlocks& blocks, size_t begin, size_t end,int state) {
+        const FType constantFeedback = blocks.feedback[begin];
+        const FType constantMix = blocks.mix[begin];
         for (size_t i = begin; i < end; i++) {
+            const FType feedback = isConstant ? constantFeedback : blocks.feedback[i];
+            const FType mix = isConstant ? constantMix : blocks.mix[i];
             FType sample = data[i];
-            auto withFb = sample + p.feedback.get(i) * getFeedback<channel>();
+            auto withFb = sample + feedback * getFeedback<channel>();
             for (int j = 0; j < state; j++) {
                 withFb = m_APFArray[j].processSingle(m_APFCoeffects[channel], withFb, channel);
             }
-            auto mixout = sample + p.mix.get(i) * withFb;
+            auto mixout = sample + mix * withFb;
             fbUpdate<channel>(withFb);
             data[i] = mixout;
         }
@@ -431,6 +498,10 @@ private:
     FType m_oneDivNyquistRate{};
     FType m_sampleRate{};
     FPolyType m_fbValue{};
+    SampleBuffer m_feedbackBuffer;
+    SampleBuffer m_mixBuffer;
+    SampleBuffer m_barberpoleRateBuffer;
+    SampleBuffer m_barberpolePhaseBuffer;
 
     // ˲
     juce::dsp::FirstOrderTPTFilter<FType> fbLF;
@@ -562,7 +633,17 @@ void Phaser::processBlock(StereoBuffer& block, size_t begin, size_t end) {
     m_flangerImpl->process(block, begin, end);
 }
 
+void Phaser::reset() {
+    m_flangerImpl->reset();
+}
+
+double Phaser::getTailLengthSeconds() const {
+    return m_flangerImpl->getTailLengthSeconds();
+}
+
+#if ! RPSYNTH_HEADLESS
 std::unique_ptr<ui::ContainModulableComponent> Phaser::createEffectPanel() {
     return std::make_unique<PhaserPanel>(*m_allFlangerParameters);
 }
+#endif
 }
\ No newline at end of file
@@ -41,7 +41,13 @@ public:
 
     void processBlock(StereoBuffer& block, size_t begin, size_t end) override;
 
+    void reset() override;
+
+    double getTailLengthSeconds() const override;
+
+#if ! RPSYNTH_HEADLESS
     std::unique_ptr<ui::ContainModulableComponent> createEffectPanel() override;
+#endif
 
 private:
     //================================================================================
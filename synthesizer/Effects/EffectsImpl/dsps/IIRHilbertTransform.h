@@ -66,6 +66,16 @@ struct IIRHilbertTransformer {
         }
         m_unitDelay = copy;
     }
+
+    void reset() {
+        m_unitDelay = SampleType{};
+        for (PolyphaseAPF& apf : m_realAPFs) {
+            apf.reset();
+        }
+        for (PolyphaseAPF& apf : m_imagAPFs) {
+            apf.reset();
+        }
+    }
 private:
     struct PolyphaseAPF {
         /*        +------g(a)---+
@@ -86,6 +96,11 @@ private:
         void setA(SampleType a) {
             m_a = a;
         }
+
+        void reset() {
+            m_z0 = SampleType{};
+            m_z1 = SampleType{};
+        }
     private:
         SampleType m_z0{};
         SampleType m_z1{};
@@ -8,6 +8,7 @@
   ==============================================================================
 */
 
+#include <algorithm>
 #include "OrderableEffectsChain.h"
 #include "EffectProcessorBase.h"
 
@@ -25,13 +26,15 @@ namespace rpSynth::audio {
 OrderableEffectsChain::OrderableEffectsChain(const juce::String& ID)
     : AudioProcessorBase(ID) {
     // Add all effect processor into it please
-    m_effectsChain.emplace_back(std::make_shared<effects::Flanger>(*this));
-    m_effectsChain.emplace_back(std::make_shared<effects::Phaser>(*this));
+    m_effects.emplace_back(std::make_shared<effects::Flanger>(*this));
+    m_effects.emplace_back(std::make_shared<effects::Phaser>(*this));
+    m_effectsChain = m_effects;
 
     // And set default index please
     for (int i = 0; auto & p : m_effectsChain) {
         m_effectProcessorIndexes.set(p->getEffectName(), i++);
     }
+    publishOrder();
 }
 
 OrderableEffectsChain::~OrderableEffectsChain() {
@@ -44,45 +47,75 @@ OrderableEffectsChain::~OrderableEffectsChain() {
 //================================================================================
 // implement for AudioProcessorBase
 void OrderableEffectsChain::addParameterToLayout(juce::AudioProcessorValueTreeState::ParameterLayout& layout) {
-    for (auto& p : m_effectsChain) {
+    for (auto& p : m_effects) {
         p->addParameterToLayout(layout);
     }
 }
 
 void OrderableEffectsChain::updateParameters(size_t numSamples) {
-    for (auto& p : m_effectsChain) {
-        p->updateParameters(numSamples);
+    // a disabled effect costs nothing,its parameters stay where they were
+    const FType maxGainStep = m_fadeStepPerSample * static_cast<FType>(numSamples);
+    for (auto& p : m_effects) {
+        if (p->updateFade(maxGainStep)) {
+            p->updateParameters(numSamples);
+        }
     }
 }
 
 void OrderableEffectsChain::prepareParameters(FType sampleRate, size_t numSamples) {
-    for (auto& p : m_effectsChain) {
+    for (auto& p : m_effects) {
         p->prepareParameters(sampleRate, numSamples);
+        p->snapFade();
     }
 }
 
 void OrderableEffectsChain::prepare(FType sampleRate, size_t numSamlpes) {
-    for (auto& p : m_effectsChain) {
+    for (auto& p : m_effects) {
         p->prepare(sampleRate, numSamlpes);
+        p->prepareSilenceTracking(sampleRate);
     }
 
     m_audioBuffer.resize(numSamlpes);
+    m_dryBuffer.resize(numSamlpes);
+    m_fadeStepPerSample = static_cast<FType>(1) / (effects::EffectProcessorBase::kFadeTimeInSeconds * sampleRate);
 }
 
 void OrderableEffectsChain::process(size_t beginSamplePos, size_t endSamplePos) {
-    // copy buffer first
-    size_t size = m_audioBuffer.left.size();
-    juce::FloatVectorOperations::copy(m_audioBuffer.left.data(), m_inputBuffer->left.data(), size);
-    juce::FloatVectorOperations::copy(m_audioBuffer.right.data(), m_inputBuffer->right.data(), size);
-
-    // order lock
-    const juce::ScopedLock lock{m_orderLock};
+    // nothing to do,hand the input on
+    const bool isInputSilent = m_inputBuffer->isSilent;
+    const bool anyActive = std::ranges::any_of(m_effects, [isInputSilent](const auto& p) {
+        return p->getFadeState().isActive() && !(isInputSilent && p->isSleeping());
+    });
+    if (!anyActive) {
+        m_chainOutput = m_inputBuffer;
+        return;
+    }
 
-    for (auto& p : m_effectsChain) {
+    // copy buffer first
+    const auto numSamples = static_cast<int>(endSamplePos - beginSamplePos);
+    juce::FloatVectorOperations::copy(m_audioBuffer.left.data() + beginSamplePos, m_inputBuffer->left.data() + beginSamplePos, numSamples);
+    juce::FloatVectorOperations::copy(m_audioBuffer.right.data() + beginSamplePos, m_inputBuffer->right.data() + beginSamplePos, numSamples);
+    m_audioBuffer.isMono = m_inputBuffer->isMono;
+    m_audioBuffer.isSilent = isInputSilent;
+    m_chainOutput = &m_audioBuffer;
+
+    // never blocks,a reorder on the message thread shows up from the next block on
+    for (auto* p : m_order.acquire()->effects) {
         p->process(beginSamplePos, endSamplePos);
     }
 }
 
+double OrderableEffectsChain::getTailLengthSeconds() const {
+    // effects run one after another,so their tails add up
+    double seconds = 0.0;
+    for (const auto& p : m_effects) {
+        if (p->notBypass->get()) {
+            seconds += p->getTailLengthSeconds();
+        }
+    }
+    return seconds;
+}
+
 void OrderableEffectsChain::saveExtraState(juce::XmlElement& xml) {
     // Create catalog
     auto* chainXML = xml.createNewChildElement(getProcessorID());
@@ -123,6 +156,7 @@ void OrderableEffectsChain::loadExtraState(juce::XmlElement& xml, juce::AudioPro
         copy[newIndex] = p;
     }
     m_effectsChain.swap(copy);
+    publishOrder();
 
     // each processor load extra state
     for (auto& p : m_effectsChain) {
@@ -141,6 +175,36 @@ void OrderableEffectsChain::setAudioInput(NonNullPtr<StereoBuffer> input) {
     m_inputBuffer = input.ptr;
 }
 
+void OrderableEffectsChain::setPipelined(bool shouldBePipelined) {
+    for (auto& p : m_effects) {
+        p->setPipelined(shouldBePipelined);
+    }
+}
+
+void OrderableEffectsChain::preparePipelineSlots(size_t numSlots) {
+    for (auto& p : m_effects) {
+        p->preparePipelineSlots(numSlots);
+    }
+}
+
+void OrderableEffectsChain::storePipelineBlock(size_t slot) {
+    for (auto& p : m_effects) {
+        p->storePipelineBlock(slot);
+    }
+}
+
+void OrderableEffectsChain::swapPipelineBuffers() {
+    for (auto& p : m_effects) {
+        p->swapPipelineBuffers();
+    }
+}
+
+void OrderableEffectsChain::setPipelineReadSlot(size_t slot) {
+    for (auto& p : m_effects) {
+        p->setPipelineReadSlot(slot);
+    }
+}
+
 void OrderableEffectsChain::reOrderProcessor(int oldIndex, int newIndex) {
     if (newIndex == oldIndex) return;
 
@@ -166,8 +230,16 @@ void OrderableEffectsChain::reOrderProcessor(int oldIndex, int newIndex) {
     }
 
     // swap chain
-    const juce::ScopedLock lock{m_orderLock};
     m_effectsChain.swap(newProcessorOrder);
+    publishOrder();
+}
+
+void OrderableEffectsChain::publishOrder() {
+    auto order = std::make_unique<EffectOrder>();
+    for (auto& p : m_effectsChain) {
+        order->effects.push_back(p.get());
+    }
+    m_order.publish(std::move(order));
 }
 //================================================================================
 
@@ -10,6 +10,7 @@
 
 #pragma once
 #include "synthesizer/AudioProcessorBase.h"
+#include "synthesizer/utils/LockFreePublisher.h"
 
 namespace rpSynth::audio::effects {
 class EffectProcessorBase;
@@ -37,9 +38,27 @@ public:
 
     //================================================================================
     void setAudioInput(NonNullPtr<StereoBuffer> input);
-    StereoBuffer* getChainOutput() { return &m_audioBuffer; }
+    // the input itself when every effect is off
+    StereoBuffer* getChainOutput() { return m_chainOutput; }
+    // scratch for an effect that is fading
+    StereoBuffer& getDryBuffer() { return m_dryBuffer; }
     void reOrderProcessor(const juce::String& processorID, int newIndex);
     void reOrderProcessor(int oldIndex, int newIndex);
+
+    /**
+     * @brief Tail of every enabled effect,callable from any thread
+    */
+    double getTailLengthSeconds() const;
+
+    /**
+     * @brief Enable fades of every effect,kept and handed over to the reader like
+     *        MyAudioProcessParameter's pipeline slots
+    */
+    void setPipelined(bool shouldBePipelined);
+    void preparePipelineSlots(size_t numSlots);
+    void storePipelineBlock(size_t slot);
+    void swapPipelineBuffers();
+    void setPipelineReadSlot(size_t slot);
     decltype(auto) getAllEffectsProcessor() const { return m_effectsChain; }
     int getEffectOrder(const juce::String& name) const { return m_effectProcessorIndexes[name]; }
     std::function<void()> onOrderChanged;
@@ -47,15 +66,32 @@ public:
 private:
     //================================================================================
     // Effect chain ordering
-    juce::CriticalSection m_orderLock;
+
+    // processing order seen by the audio thread,never changed once published
+    struct EffectOrder {
+        std::vector<effects::EffectProcessorBase*> effects;
+    };
+
+    /**
+     * @brief Publish m_effectsChain as the new processing order,message thread only
+    */
+    void publishOrder();
+
+    // every effect in creation order,fixed after the constructor so any thread may walk it
+    std::vector<std::shared_ptr<effects::EffectProcessorBase>> m_effects;
+    // message thread only
     std::vector<std::shared_ptr<effects::EffectProcessorBase>> m_effectsChain;
     juce::HashMap<juce::String, int> m_effectProcessorIndexes;
+    LockFreePublisher<EffectOrder> m_order;
     //================================================================================
 
     //================================================================================
     // Audio buffer
     StereoBuffer* m_inputBuffer;
     StereoBuffer m_audioBuffer;
+    StereoBuffer m_dryBuffer;
+    StereoBuffer* m_chainOutput = &m_audioBuffer;
+    FType m_fadeStepPerSample{};
     //================================================================================
 };
 }
\ No newline at end of file
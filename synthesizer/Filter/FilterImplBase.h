@@ -10,6 +10,7 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "concepts.h"
 #include "synthesizer/types.h"
 
 namespace rpSynth::ui {
@@ -44,7 +45,16 @@ public:
     virtual void prepare(FType /*sampleRate*/, size_t /*numSamples*/) {}
     virtual void doLayout(ui::FilterKnobsPanel&) {}
     //=========================================================================
+
+    //=========================================================================
+    // Oversampling,set by MainFilter.process() then gets 2^shift samples for
+    // every sample of the parameters,read them at (i >> shift).
+    virtual void setOversamplingShift(size_t shift) { m_oversamplingShift = shift; }
+    size_t getOversamplingShift() const { return m_oversamplingShift; }
+    FType getOversamplingFactor() const { return static_cast<FType>(size_t{1} << m_oversamplingShift); }
+    //=========================================================================
 private:
     juce::String m_filterName;
+    size_t m_oversamplingShift = 0;
 };
 };
\ No newline at end of file
@@ -11,26 +11,79 @@
 #include "MoogLadderFilter.h"
 #include "synthesizer/Filter/AllFilterParameters.h"
 #include "synthesizer/WrapParameter.h"
+#if ! RPSYNTH_HEADLESS
 #include "ui/filter/FilterPanel.h"
+#endif
 
 namespace rpSynth::audio::filters::analog {
 void MoogLadderFilter::process(rpSynth::audio::StereoBuffer& input, rpSynth::audio::StereoBuffer& output, size_t begin, size_t end) {
-    m_parameters.cutoff.applySemitoneToHertz(begin, end);
+    // parameters are at the base rate
+    const size_t shift = getOversamplingShift();
+    const FType* cutoffHz = m_parameters.cutoff.getHertzBlock(begin >> shift, end >> shift, m_cutoffBuffer.data());
+    const FType* resonance = m_parameters.resonance.getBlock(begin >> shift, end >> shift, m_resonanceBuffer.data());
+
+    // a mono input keeps both lanes equal
+    if (input.isMono) {
+        c_state.c_az1 = c_state.c_az1.broadcast<0>();
+        c_state.c_az2 = c_state.c_az2.broadcast<0>();
+        c_state.c_az3 = c_state.c_az3.broadcast<0>();
+        c_state.c_az4 = c_state.c_az4.broadcast<0>();
+        c_state.c_az5 = c_state.c_az5.broadcast<0>();
+        c_state.c_amf = c_state.c_amf.broadcast<0>();
+        c_state.c_tanhZ1 = c_state.c_tanhZ1.broadcast<0>();
+        c_state.c_tanhZ2 = c_state.c_tanhZ2.broadcast<0>();
+        c_state.c_tanhZ3 = c_state.c_tanhZ3.broadcast<0>();
+    }
+    output.isMono = input.isMono;
 
-    processLeft(input.left.data(), output.left.data(), begin, end);
-    processRight(input.right.data(), output.right.data(), begin, end);
+    processStereo(input.left.data(), input.right.data(), output.left.data(), output.right.data(),
+                  cutoffHz, resonance, begin, end);
 }
 
 void MoogLadderFilter::reset() {
-    c_left = Coeffects{};
-    c_right = Coeffects{};
+    c_state = Coeffects{};
+    m_isTuningValid = false;
 }
 
-void MoogLadderFilter::prepare(rpSynth::audio::FType sampleRate, size_t /*numSamples*/) {
+void MoogLadderFilter::prepare(rpSynth::audio::FType sampleRate, size_t numSamples) {
     m_oneDivSampleRate = 1 / sampleRate;
     m_oneDivNyquistRate = m_oneDivSampleRate * static_cast<FType>(2);
+    m_cutoffBuffer.resize(numSamples);
+    m_resonanceBuffer.resize(numSamples);
+}
+
+MoogLadderFilter::Tuning MoogLadderFilter::calcTuning(FType cutoffHz, FType resonance) const {
+    FType kfc = cutoffHz * m_oneDivNyquistRate;
+    FType kf = kfc * static_cast<FType>(0.5f);
+
+    // frequency & amplitude correction
+    FType kfcr = static_cast<FType>(1.8730 * (kfc * kfc * kfc) + 0.4955 * (kfc * kfc) - 0.6490 * kfc + 0.9988);
+    FType kacr = static_cast<FType>(-3.9364 * (kfc * kfc) + 1.8409 * kfc + 0.9968);
+
+    float x = -juce::MathConstants<FType>::twoPi * kfcr * kf;
+    float exp_out = juce::dsp::FastMathApproximations::exp(x);
+    float k2vg = kV2 * (static_cast<FType>(1) - exp_out); // filter tuning
+
+    return {k2vg, static_cast<FType>(4) * resonance * kacr};
 }
 
+const MoogLadderFilter::Tuning& MoogLadderFilter::getTuning(FType cutoffHz, FType resonance) {
+    if (!m_isTuningValid
+        || std::abs(cutoffHz - m_cachedCutoffHz) > kTuningTolerance * m_cachedCutoffHz
+        || std::abs(resonance - m_cachedResonance) > kTuningTolerance) {
+        m_cachedTuning = calcTuning(cutoffHz, resonance);
+        m_cachedCutoffHz = cutoffHz;
+        m_cachedResonance = resonance;
+        if (!m_isTuningValid) {
+            // nothing to ramp from
+            m_currentTuning = m_cachedTuning;
+            m_isTuningValid = true;
+        }
+    }
+    return m_cachedTuning;
+}
+
+#if ! RPSYNTH_HEADLESS
 void MoogLadderFilter::doLayout(ui::FilterKnobsPanel& p) {
     p.m_cutoff.setVisible(true);
     p.m_resonance.setVisible(true);
@@ -38,100 +91,75 @@ void MoogLadderFilter::doLayout(ui::FilterKnobsPanel& p) {
     p.m_cutoff.setBounds(0, 0, 70, 70);
     p.m_resonance.setBounds(80, 0, 70, 70);
 }
-
-void MoogLadderFilter::processLeft(FType* input, FType* output, size_t begin, size_t end) {
-    for (size_t i = begin; i < end; i++) {
-        static constexpr FType v2 = static_cast<FType>(40000);   // twice the 'thermal voltage of a transistor'
-        static constexpr FType invV2 = 1 / v2;
-
-        FType cutoff_hz = m_parameters.cutoff.getRaw(i);
-        FType kfc = cutoff_hz * m_oneDivNyquistRate;
-        FType kf = kfc * static_cast<FType>(0.5f);
-
-        // frequency & amplitude correction
-        FType kfcr = static_cast<FType>(1.8730 * (kfc * kfc * kfc) + 0.4955 * (kfc * kfc) - 0.6490 * kfc + 0.9988);
-        FType kacr = static_cast<FType>(-3.9364 * (kfc * kfc) + 1.8409 * kfc + 0.9968);
-
-        float x = -juce::MathConstants<FType>::twoPi * kfcr * kf;
-        float exp_out = juce::dsp::FastMathApproximations::exp(x);
-        float k2vg = v2 * (static_cast<FType>(1) - exp_out); // filter tuning
-
-        // cascade of 4 1st order sections
-        float resonance = m_parameters.resonance.get(i);
-        float temp = static_cast<FType>(4) * resonance * c_left.c_amf * kacr;
-
-        float x1 = (input[i] - temp) * invV2;
-        float tanh1 = juce::dsp::FastMathApproximations::tanh(x1);
-        float x2 = c_left.c_az1 * invV2;
-        float tanh2 = juce::dsp::FastMathApproximations::tanh(x2);
-        c_left.c_ay1 = c_left.c_az1 + k2vg * (tanh1 - tanh2);
-
-        c_left.c_ay1 = c_left.c_az1 + k2vg * (juce::dsp::FastMathApproximations::tanh((input[i] - temp) * invV2) - juce::dsp::FastMathApproximations::tanh(c_left.c_az1 * invV2));
-        c_left.c_az1 = c_left.c_ay1;
-
-        c_left.c_ay2 = c_left.c_az2 + k2vg * (juce::dsp::FastMathApproximations::tanh(c_left.c_ay1 * invV2) - juce::dsp::FastMathApproximations::tanh(c_left.c_az2 * invV2));
-        c_left.c_az2 = c_left.c_ay2;
-
-        c_left.c_ay3 = c_left.c_az3 + k2vg * (juce::dsp::FastMathApproximations::tanh(c_left.c_ay2 * invV2) - juce::dsp::FastMathApproximations::tanh(c_left.c_az3 * invV2));
-        c_left.c_az3 = c_left.c_ay3;
-
-        c_left.c_ay4 = c_left.c_az4 + k2vg * (juce::dsp::FastMathApproximations::tanh(c_left.c_ay3 * invV2) - juce::dsp::FastMathApproximations::tanh(c_left.c_az4 * invV2));
-        c_left.c_az4 = c_left.c_ay4;
-
-        // 1/2-sample delay for phase compensation
-        c_left.c_amf = (c_left.c_ay4 + c_left.c_az5) * static_cast<FType>(0.5);
-        c_left.c_az5 = c_left.c_ay4;
-
-        // end of sm code
-        output[i] = c_left.c_amf;
+#endif
+
+void MoogLadderFilter::processStereo(const FType* inputLeft, const FType* inputRight,
+                                     FType* outputLeft, FType* outputRight,
+                                     const FType* cutoffHz, const FType* resonance,
+                                     size_t begin, size_t end) {
+    // tuning is shared by both channels,oversampled the cutoff is a smaller part of nyquist
+    const size_t shift = getOversamplingShift();
+    const FType oneDivFactor = static_cast<FType>(1) / getOversamplingFactor();
+    const size_t interval = kTuningInterval << shift;
+
+    // every segment ramps to the tuning of its last sample
+    for (size_t segmentBegin = begin; segmentBegin < end;) {
+        const size_t segmentEnd = juce::jmin(end, segmentBegin + interval);
+        const size_t last = (segmentEnd - 1) >> shift;
+        const Tuning to = getTuning(cutoffHz[last] * oneDivFactor, resonance[last]);
+        processSegment(inputLeft, inputRight, outputLeft, outputRight, m_currentTuning, to, segmentBegin, segmentEnd);
+        m_currentTuning = to;
+        segmentBegin = segmentEnd;
     }
 }
 
-void MoogLadderFilter::processRight(FType* input, FType* output, size_t begin, size_t end) {
+void MoogLadderFilter::processSegment(const FType* inputLeft, const FType* inputRight,
+                                      FType* outputLeft, FType* outputRight,
+                                      const Tuning& from, const Tuning& to,
+                                      size_t begin, size_t end) {
+    const auto invV2 = FloatLane::expand(kInvV2);
+    const auto half = FloatLane::expand(static_cast<FType>(0.5));
+    auto c = c_state;
+
+    const FType oneDivNumSamples = static_cast<FType>(1) / static_cast<FType>(end - begin);
+    const FType k2vgStep = (to.k2vg - from.k2vg) * oneDivNumSamples;
+    const FType feedbackGainStep = (to.feedbackGain - from.feedbackGain) * oneDivNumSamples;
+    FType k2vgValue = from.k2vg;
+    FType feedbackGainValue = from.feedbackGain;
     for (size_t i = begin; i < end; i++) {
-        static constexpr FType v2 = static_cast<FType>(40000);   // twice the 'thermal voltage of a transistor'
-        static constexpr FType invV2 = 1 / v2;
-
-        FType cutoff_hz = m_parameters.cutoff.getRaw(i);
-        FType kfc = cutoff_hz * m_oneDivNyquistRate;
-        FType kf = kfc * static_cast<FType>(0.5f);
-
-        // frequency & amplitude correction
-        FType kfcr = static_cast<FType>(1.8730 * (kfc * kfc * kfc) + 0.4955 * (kfc * kfc) - 0.6490 * kfc + 0.9988);
-        FType kacr = static_cast<FType>(-3.9364 * (kfc * kfc) + 1.8409 * kfc + 0.9968);
-
-        float x = -juce::MathConstants<FType>::twoPi * kfcr * kf;
-        float exp_out = juce::dsp::FastMathApproximations::exp(x);
-        float k2vg = v2 * (static_cast<FType>(1) - exp_out); // filter tuning
+        k2vgValue += k2vgStep;
+        feedbackGainValue += feedbackGainStep;
+        const auto k2vg = FloatLane::expand(k2vgValue);
+        const auto input = FloatLane::fromStereo(inputLeft[i], inputRight[i]);
 
         // cascade of 4 1st order sections
-        float resonance = m_parameters.resonance.get(i);
-        float temp = static_cast<FType>(4) * resonance * c_right.c_amf * kacr;
-
-        float x1 = (input[i] - temp) * invV2;
-        float tanh1 = juce::dsp::FastMathApproximations::tanh(x1);
-        float x2 = c_right.c_az1 * invV2;
-        float tanh2 = juce::dsp::FastMathApproximations::tanh(x2);
-        c_right.c_ay1 = c_right.c_az1 + k2vg * (tanh1 - tanh2);
+        const auto temp = FloatLane::expand(feedbackGainValue) * c.c_amf;
 
-        c_right.c_ay1 = c_right.c_az1 + k2vg * (juce::dsp::FastMathApproximations::tanh((input[i] - temp) * invV2) - juce::dsp::FastMathApproximations::tanh(c_right.c_az1 * invV2));
-        c_right.c_az1 = c_right.c_ay1;
+        const auto tanhIn = kernels::tanh((input - temp) * invV2);
+        c.c_az1 += k2vg * (tanhIn - c.c_tanhZ1);
 
-        c_right.c_ay2 = c_right.c_az2 + k2vg * (juce::dsp::FastMathApproximations::tanh(c_right.c_ay1 * invV2) - juce::dsp::FastMathApproximations::tanh(c_right.c_az2 * invV2));
-        c_right.c_az2 = c_right.c_ay2;
+        const auto tanhY1 = kernels::tanh(c.c_az1 * invV2);
+        c.c_az2 += k2vg * (tanhY1 - c.c_tanhZ2);
 
-        c_right.c_ay3 = c_right.c_az3 + k2vg * (juce::dsp::FastMathApproximations::tanh(c_right.c_ay2 * invV2) - juce::dsp::FastMathApproximations::tanh(c_right.c_az3 * invV2));
-        c_right.c_az3 = c_right.c_ay3;
+        const auto tanhY2 = kernels::tanh(c.c_az2 * invV2);
+        c.c_az3 += k2vg * (tanhY2 - c.c_tanhZ3);
 
-        c_right.c_ay4 = c_right.c_az4 + k2vg * (juce::dsp::FastMathApproximations::tanh(c_right.c_ay3 * invV2) - juce::dsp::FastMathApproximations::tanh(c_right.c_az4 * invV2));
-        c_right.c_az4 = c_right.c_ay4;
+        const auto tanhY3 = kernels::tanh(c.c_az3 * invV2);
+        const auto ay4 = c.c_az4 + k2vg * (tanhY3 - kernels::tanh(c.c_az4 * invV2));
+        c.c_az4 = ay4;
 
         // 1/2-sample delay for phase compensation
-        c_right.c_amf = (c_right.c_ay4 + c_right.c_az5) * static_cast<FType>(0.5);
-        c_right.c_az5 = c_right.c_ay4;
+        c.c_amf = (ay4 + c.c_az5) * half;
+        c.c_az5 = ay4;
+
+        c.c_tanhZ1 = tanhY1;
+        c.c_tanhZ2 = tanhY2;
+        c.c_tanhZ3 = tanhY3;
 
         // end of sm code
-        output[i] = c_right.c_amf;
+        outputLeft[i] = c.c_amf.left();
+        outputRight[i] = c.c_amf.right();
     }
+    c_state = c;
 }
 }
\ No newline at end of file
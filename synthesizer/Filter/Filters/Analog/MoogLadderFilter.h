@@ -10,6 +10,7 @@
 
 #pragma once
 #include "synthesizer/Filter/FilterImplBase.h"
+#include "synthesizer/utils/SimdLane.h"
 
 namespace rpSynth::audio::filters::analog {
 class MoogLadderFilter : public FilterImplBase {
@@ -28,31 +29,69 @@ public:
                  size_t begin, size_t end) override;
     void reset() override;
     void prepare(rpSynth::audio::FType sampleRate, size_t numSamples) override;
+#if ! RPSYNTH_HEADLESS
     void doLayout(ui::FilterKnobsPanel&) override;
+#endif
     //=========================================================================
 private:
     FType m_oneDivSampleRate;
     FType m_oneDivNyquistRate;
 
     //================================================================================
-    // Filter coeffects
+    // Filter state,left and right in one lane
     struct Coeffects {
-        float c_az1;
-        float c_az2;
-        float c_az3;
-        float c_az4;
-        float c_az5;
-        float c_ay1;
-        float c_ay2;
-        float c_ay3;
-        float c_ay4;
-        float c_amf;
+        FloatLane c_az1{};
+        FloatLane c_az2{};
+        FloatLane c_az3{};
+        FloatLane c_az4{};
+        FloatLane c_az5{};
+        FloatLane c_amf{};
+        // tanh(c_azN * kInvV2),stage N + 1 computed it last sample
+        FloatLane c_tanhZ1{};
+        FloatLane c_tanhZ2{};
+        FloatLane c_tanhZ3{};
     };
-    Coeffects c_left;
-    Coeffects c_right;
+    Coeffects c_state;
+
+    static constexpr FType kV2 = static_cast<FType>(40000);   // twice the 'thermal voltage of a transistor'
+    static constexpr FType kInvV2 = 1 / kV2;
+
+    // depends on cutoff and resonance only
+    struct Tuning {
+        FType k2vg;
+        FType feedbackGain;
+    };
+    Tuning calcTuning(FType cutoffHz, FType resonance) const;
+
     //================================================================================
-    forcedinline void processLeft(FType* input, FType* output, size_t begin, size_t end);
-    forcedinline void processRight(FType* input, FType* output, size_t begin, size_t end);
+    // Tuning at control rate,computed every kTuningInterval parameter samples and
+    // linear between.Modulators move at kControlRate,so this loses next to nothing.
+    static constexpr size_t kTuningInterval = 16;
+    // relative cutoff change and resonance change that need a new tuning
+    static constexpr FType kTuningTolerance = static_cast<FType>(1e-4);
+
+    /**
+     * @brief Tuning of cutoffHz and resonance,the last one again if neither moved past tolerance
+    */
+    const Tuning& getTuning(FType cutoffHz, FType resonance);
+
+    Tuning m_currentTuning{};   // of the last processed sample
+    Tuning m_cachedTuning{};
+    FType m_cachedCutoffHz{};
+    FType m_cachedResonance{};
+    bool m_isTuningValid = false;
+    //================================================================================
+    forcedinline void processStereo(const FType* inputLeft, const FType* inputRight,
+                                    FType* outputLeft, FType* outputRight,
+                                    const FType* cutoffHz, const FType* resonance,
+                                    size_t begin, size_t end);
+    forcedinline void processSegment(const FType* inputLeft, const FType* inputRight,
+                                     FType* outputLeft, FType* outputRight,
+                                     const Tuning& from, const Tuning& to,
+                                     size_t begin, size_t end);
+
+    SampleBuffer m_cutoffBuffer;
+    SampleBuffer m_resonanceBuffer;
 private:
     AllFilterParameters& m_parameters;
 };
@@ -9,7 +9,9 @@
 */
 
 #include "HighPass.h"
+#if ! RPSYNTH_HEADLESS
 #include "ui/filter/FilterPanel.h"
+#endif
 
 namespace rpSynth::audio::filters {
 void HighPass::process(rpSynth::audio::StereoBuffer& input, rpSynth::audio::StereoBuffer& output, size_t begin, size_t end) {
@@ -17,6 +19,12 @@ void HighPass::process(rpSynth::audio::StereoBuffer& input, rpSynth::audio::Ster
 
     for (size_t i = begin; i < end; i++) {
         output.left[i] = input.left[i] - output.left[i];
+    }
+    if (input.isMono) {
+        output.copyLeftToRight(begin, end);
+        return;
+    }
+    for (size_t i = begin; i < end; i++) {
         output.right[i] = input.right[i] - output.right[i];
     }
 }
@@ -29,7 +37,9 @@ void HighPass::prepare(rpSynth::audio::FType sampleRate, size_t numSamples) {
     lowpass.prepare(sampleRate, numSamples);
 }
 
+#if ! RPSYNTH_HEADLESS
 void HighPass::doLayout(ui::FilterKnobsPanel& p) {
     lowpass.doLayout(p);
 }
+#endif
 }
\ No newline at end of file
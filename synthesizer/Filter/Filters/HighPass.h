@@ -33,7 +33,13 @@ public:
                          size_t begin, size_t end) override;
     virtual void reset() override;
     virtual void prepare(rpSynth::audio::FType sampleRate, size_t numSamples) override;
+    void setOversamplingShift(size_t shift) override {
+        FilterImplBase::setOversamplingShift(shift);
+        lowpass.setOversamplingShift(shift);
+    }
+#if ! RPSYNTH_HEADLESS
     void doLayout(ui::FilterKnobsPanel&) override;
+#endif
     //=========================================================================
 private:
     LowPass lowpass;
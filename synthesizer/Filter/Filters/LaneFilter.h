@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    LaneFilter.h
+    Created: 17 Oct 2026 11:21:37pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "synthesizer/utils/SimdLane.h"
+
+namespace rpSynth::audio::filters {
+/**
+ * @brief Filter of Filter.h over FloatLane,every lane is one channel.
+ *        Coefficients are shared by all lanes,so they are computed once.
+*/
+class LaneFilter {
+public:
+    void reset() {
+        *this = LaneFilter{};
+    }
+
+    /**
+     * @brief Every lane continues from the state of lane index
+    */
+    template<int index>
+    void copyStateFrom() {
+        tmp1 = tmp1.broadcast<index>();
+        tmp2 = tmp2.broadcast<index>();
+        out1 = out1.broadcast<index>();
+        out2 = out2.broadcast<index>();
+    }
+
+    /**
+     * @brief Clear the state of one lane only,e.g. a voice that starts a new note
+    */
+    void resetLane(size_t lane) {
+        for (auto* state : {&tmp1, &tmp2, &out1, &out2}) {
+            std::array<float, FloatLane::kNumElements> values;
+            state->store(values.data());
+            values[lane] = 0.f;
+            *state = FloatLane::load(values.data());
+        }
+    }
+
+    /**
+     * @brief Same as Filter::LPF2_ResoLimit_limit
+    */
+    FloatLane LPF2_ResoLimit_limit(FloatLane vin, float ctof, float reso, float limVol, float limK) {
+        return LPF2_ResoLimit_limit(vin,
+                                    FloatLane::expand(ctof),
+                                    FloatLane::expand(reso + reso / (1.0f - ctof)),
+                                    FloatLane::expand(limVol),
+                                    FloatLane::expand(1.0f - limK));
+    }
+
+    /**
+     * @brief Every lane with its own coefficients,e.g. one voice per lane
+     * @param fb reso + reso / (1 - ctof)
+     * @param oneMinusK 1 - limK
+    */
+    FloatLane LPF2_ResoLimit_limit(FloatLane vin, FloatLane c, FloatLane fb, FloatLane limit, FloatLane oneMinusK) {
+        tmp1 += c * (vin - tmp1);
+        out1 += c * (tmp1 - out1);
+        tmp2 += c * (out1 - tmp2 + fb * (tmp2 - out2));
+        out2 += c * (tmp2 - out2);
+        out1 = kernels::softLimit(out1, limit, oneMinusK);
+        tmp1 = kernels::softLimit(tmp1, limit, oneMinusK);
+        out2 = kernels::softLimit(out2, limit, oneMinusK);
+        tmp2 = kernels::softLimit(tmp2, limit, oneMinusK);
+        return out2;
+    }
+private:
+    FloatLane tmp1{};
+    FloatLane tmp2{};
+    FloatLane out1{};
+    FloatLane out2{};
+};
+}
@@ -12,31 +12,68 @@
 #include "concepts.h"
 #include "synthesizer/WrapParameter.h"
 #include "synthesizer/Filter/AllFilterParameters.h"
+#if ! RPSYNTH_HEADLESS
 #include "ui/filter/FilterPanel.h"
+#endif
 
 namespace rpSynth::audio::filters {
 void LowPass::process(rpSynth::audio::StereoBuffer& input, rpSynth::audio::StereoBuffer& output, size_t begin, size_t end) {
-    m_parameters.cutoff.applySemitoneToHertz(begin, end);
-    for (size_t i = begin; i < end; i++) {
-        FType cutoff = m_parameters.cutoff.getRaw(i) * m_oneDivNyquistRate;
-        FType res = m_parameters.resonance.get(i);
-        FType lv = m_parameters.limitVolume.get(i);
-        FType lk = m_parameters.limitK.get(i);
+    // left and right run together in one lane,a mono input keeps both lanes equal
+    if (input.isMono) {
+        m_filter.copyStateFrom<0>();
+    }
+    output.isMono = input.isMono;
+
+    // parameters are at the base rate
+    const size_t shift = getOversamplingShift();
+    const FType oneDivNyquistRate = m_oneDivNyquistRate / getOversamplingFactor();
 
-        output.left[i] = LF.LPF2_ResoLimit_limit(input.left[i], cutoff, res, lv,lk);
-        output.right[i] = RF.LPF2_ResoLimit_limit(input.right[i], cutoff, res, lv, lk);
+    if (m_parameters.cutoff.isConstant()
+        && m_parameters.resonance.isConstant()
+        && m_parameters.limitVolume.isConstant()
+        && m_parameters.limitK.isConstant()) {
+        const FType cutoff = kernels::semitoneToHertz(m_parameters.cutoff.get(begin >> shift)) * oneDivNyquistRate;
+        const FType res = m_parameters.resonance.get(begin >> shift);
+        const FType lv = m_parameters.limitVolume.get(begin >> shift);
+        const FType lk = m_parameters.limitK.get(begin >> shift);
+        for (size_t i = begin; i < end; i++) {
+            const auto out = m_filter.LPF2_ResoLimit_limit(FloatLane::fromStereo(input.left[i], input.right[i]),
+                                                           cutoff, res, lv, lk);
+            output.left[i] = out.left();
+            output.right[i] = out.right();
+        }
+        return;
+    }
+
+    const size_t paramBegin = begin >> shift;
+    const size_t paramEnd = end >> shift;
+    const FType* cutoffHz = m_parameters.cutoff.getHertzBlock(paramBegin, paramEnd, m_cutoffBuffer.data());
+    const FType* resonance = m_parameters.resonance.getBlock(paramBegin, paramEnd, m_resonanceBuffer.data());
+    const FType* limitVolume = m_parameters.limitVolume.getBlock(paramBegin, paramEnd, m_limitVolumeBuffer.data());
+    const FType* limitK = m_parameters.limitK.getBlock(paramBegin, paramEnd, m_limitKBuffer.data());
+    for (size_t i = begin; i < end; i++) {
+        const size_t p = i >> shift;
+        const auto out = m_filter.LPF2_ResoLimit_limit(FloatLane::fromStereo(input.left[i], input.right[i]),
+                                                       cutoffHz[p] * oneDivNyquistRate,
+                                                       resonance[p], limitVolume[p], limitK[p]);
+        output.left[i] = out.left();
+        output.right[i] = out.right();
     }
 }
 
 void LowPass::reset() {
-    LF.reset();
-    RF.reset();
+    m_filter.reset();
 }
 
-void LowPass::prepare(rpSynth::audio::FType sampleRate, size_t /*numSamples*/) {
+void LowPass::prepare(rpSynth::audio::FType sampleRate, size_t numSamples) {
     m_oneDivNyquistRate = 2 / sampleRate;
+    m_cutoffBuffer.resize(numSamples);
+    m_resonanceBuffer.resize(numSamples);
+    m_limitVolumeBuffer.resize(numSamples);
+    m_limitKBuffer.resize(numSamples);
 }
 
+#if ! RPSYNTH_HEADLESS
 void LowPass::doLayout(ui::FilterKnobsPanel& p) {
     p.m_cutoff.setVisible(true);
     p.m_resonance.setVisible(true);
@@ -48,4 +85,5 @@ void LowPass::doLayout(ui::FilterKnobsPanel& p) {
     p.m_limitVolume.setBounds(160, 0, 70, 70);
     p.m_limitK.setBounds(0, 80, 70, 70);
 }
+#endif
 }
\ No newline at end of file
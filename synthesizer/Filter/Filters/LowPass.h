@@ -10,7 +10,7 @@
 
 #pragma once
 #include "synthesizer/Filter/FilterImplBase.h"
-#include "Filter.h"
+#include "LaneFilter.h"
 
 namespace rpSynth::audio::filters {
 class LowPass : public FilterImplBase {
@@ -29,12 +29,19 @@ public:
                  size_t begin, size_t end) override;
     void reset() override;
     void prepare(rpSynth::audio::FType sampleRate, size_t numSamples) override;
+#if ! RPSYNTH_HEADLESS
     void doLayout(ui::FilterKnobsPanel&) override;
+#endif
     //=========================================================================
 private:
     FType m_oneDivNyquistRate;
-    Filter LF;
-    Filter RF;
+    // left and right in one lane
+    LaneFilter m_filter;
+    // parameters of a block that is not constant
+    SampleBuffer m_cutoffBuffer;
+    SampleBuffer m_resonanceBuffer;
+    SampleBuffer m_limitVolumeBuffer;
+    SampleBuffer m_limitKBuffer;
 private:
     AllFilterParameters& m_parameters;
 };
@@ -22,15 +22,21 @@ namespace rpSynth::audio {
 MainFilter::MainFilter(const juce::String& ID)
     :AudioProcessorBase(ID) {
     m_allFilterParameters = std::make_unique<filters::AllFilterParameters>();
-    // Add all type of impl filter into hash map
+    // Add all type of impl filter
     using namespace filters;
-    m_allFilters.set(LowPass::kName, std::make_shared<LowPass>(*m_allFilterParameters));
-    m_allFilters.set(HighPass::kName, std::make_shared<HighPass>(*m_allFilterParameters));
-    m_allFilters.set(analog::MoogLadderFilter::kName, std::make_shared<analog::MoogLadderFilter>(*m_allFilterParameters));
+    m_allFilters.push_back(std::make_shared<LowPass>(*m_allFilterParameters));
+    m_allFilters.push_back(std::make_shared<HighPass>(*m_allFilterParameters));
+    m_allFilters.push_back(std::make_shared<analog::MoogLadderFilter>(*m_allFilterParameters));
+
+    // polyphase half-band IIR stages,integer latency so it can be reported
+    for (size_t shift = 1; shift <= kMaxOversamplingShift; shift++) {
+        m_oversamplers[shift - 1] = std::make_unique<juce::dsp::Oversampling<FType>>(
+            2, shift, juce::dsp::Oversampling<FType>::filterHalfBandPolyphaseIIR, false, true);
+    }
 
     // Set the default Filter impl
-    m_newFilterName = LowPass::kName;
-    m_currentFilterImpl = m_allFilters.getReference(LowPass::kName);
+    m_selectedFilterIndex = findFilterIndex(LowPass::kName);
+    m_activeFilterIndex = m_selectedFilterIndex;
 }
 
 MainFilter::~MainFilter() {
@@ -64,6 +70,13 @@ void MainFilter::addParameterToLayout(juce::AudioProcessorValueTreeState::Parame
                                                                  0.125f)
     );
 
+    auto pOversampling = std::make_unique<juce::AudioParameterChoice>(combineWithID("oversampling"),
+                                                                      combineWithID("oversampling"),
+                                                                      juce::StringArray{"1x", "2x", "4x", "8x"},
+                                                                      0);
+    m_oversamplingParameter = pOversampling.get();
+    layout.add(std::move(pOversampling));
+
     // router parameters
     for (auto& set : m_inputRouter) {
         auto pp = std::make_unique<juce::AudioParameterBool>(
@@ -95,31 +108,91 @@ void MainFilter::prepare(FType sampleRate, size_t numSamlpes) {
     m_filterInputBuffer.resize(numSamlpes);
     m_filterOutputBuffer.resize(numSamlpes);
     m_processorOutputBuffer.resize(numSamlpes);
+    m_fadingOutOutputBuffer.resize(numSamlpes << kMaxOversamplingShift);
+    m_oversampledInput.resize(numSamlpes << kMaxOversamplingShift);
+    m_oversampledOutput.resize(numSamlpes << kMaxOversamplingShift);
 
-    // init for all filters
-    for (auto f : m_allFilters) {
+    // init for all filters,at the base rate
+    for (auto& f : m_allFilters) {
         f->prepare(sampleRate, numSamlpes);
     }
+
+    // delay line holds the largest latency,a power of 2 so positions wrap with a mask
+    size_t maxLatency = 0;
+    for (auto& o : m_oversamplers) {
+        o->initProcessing(numSamlpes);
+        maxLatency = juce::jmax(maxLatency, static_cast<size_t>(o->getLatencyInSamples()));
+    }
+    const auto delayLineSize = static_cast<size_t>(juce::nextPowerOfTwo(static_cast<int>(maxLatency) + 1));
+    m_bypassDelayLine.resize(delayLineSize);
+    m_bypassDelayLine.clear();
+    m_bypassDelayMask = delayLineSize - 1;
+    m_bypassDelayWritePos = 0;
+    m_wasBypassMono = true;
+    setOversamplingShift(getRequestedOversamplingShift());
+
+    // nothing is playing yet,so switch without a crossfade
+    m_crossfadeLength = juce::jmax<size_t>(1, static_cast<size_t>(kCrossfadeTimeInSeconds * sampleRate));
+    m_rateFadePosition = m_crossfadeLength;
+    m_rateFadeDirection = 0;
+    m_fadingOutFilterIndex = -1;
+    m_activeFilterIndex = m_selectedFilterIndex.load(std::memory_order_relaxed);
+
+    m_silence.prepare(sampleRate);
 }
 
 void MainFilter::process(size_t beginSamplePos, size_t endSamplePos) {
-    // process change filter event
-    if (m_isFilterChanged) {
-        m_currentFilterImpl = m_allFilters.getReference(m_newFilterName);
-        m_currentFilterImpl->reset();
-        m_isFilterChanged = false;
+    // process change filter event,a change during a crossfade waits for it to end
+    if (const int selected = m_selectedFilterIndex.load(std::memory_order_relaxed);
+        m_fadingOutFilterIndex < 0 && selected != m_activeFilterIndex) {
+        // the incoming filter starts from rest and settles while it fades in
+        m_allFilters[selected]->reset();
+        m_fadingOutFilterIndex = m_activeFilterIndex;
+        m_activeFilterIndex = selected;
+        m_crossfadePosition = 0;
     }
 
-    // Clear outputs and input
-    m_processorOutputBuffer.clear();
-    m_filterInputBuffer.clear();
-    m_filterOutputBuffer.clear();
+    // asleep,the output is silence
+    const bool isInputSilent = std::ranges::all_of(m_inputRouter, [](const InputRouterSet& i) {
+        return i.pProcessOutputBuffer->isSilent;
+    });
+    const size_t requestedShift = getRequestedOversamplingShift();
+    if (m_silence.canSkip(isInputSilent)) {
+        // nothing to click,the new rate is taken at once
+        setOversamplingShift(requestedShift);
+        m_rateFadePosition = m_crossfadeLength;
+        m_rateFadeDirection = 0;
+        m_processorOutputBuffer.clear(beginSamplePos, endSamplePos);
+        m_processorOutputBuffer.isMono = true;
+        m_processorOutputBuffer.isSilent = true;
+        return;
+    }
+    m_processorOutputBuffer.isSilent = false;
+
+    // a changed rate fades out first,the switch happens once the output reached silence
+    // and a change back before that only fades in again
+    if (requestedShift != m_oversamplingShift) {
+        m_rateFadeDirection = -1;
+    } else if (m_rateFadeDirection < 0) {
+        m_rateFadeDirection = 1;
+    }
+    if (m_rateFadeDirection < 0 && m_rateFadePosition == 0) {
+        setOversamplingShift(requestedShift);
+        m_rateFadeDirection = 1;
+    }
 
-    // Mix input source
+    // Clear output and input of this range,the filters overwrite their output
+    m_processorOutputBuffer.clear(beginSamplePos, endSamplePos);
+    m_filterInputBuffer.clear(beginSamplePos, endSamplePos);
+
+    // Mix input source,a sum stays mono while every part of it is
     size_t numSample = endSamplePos - beginSamplePos;
+    m_filterInputBuffer.isMono = true;
+    m_processorOutputBuffer.isMono = true;
     for (auto& i : m_inputRouter) {
         // Atomic,may be Thread-safe?
         bool bypass = !i.pJuceParameter->get();
+        (bypass ? m_processorOutputBuffer : m_filterInputBuffer).isMono &= i.pProcessOutputBuffer->isMono;
         if (bypass) {
             juce::FloatVectorOperations::add(m_processorOutputBuffer.left.data() + beginSamplePos,
                                              i.pProcessOutputBuffer->left.data() + beginSamplePos,
@@ -136,22 +209,139 @@ void MainFilter::process(size_t beginSamplePos, size_t endSamplePos) {
                                              numSample);
         }
     }
+    delayBypassedInputs(beginSamplePos, endSamplePos);
+
+    // Filter process,at the oversampled rate if any
+    if (m_oversamplingShift == 0) {
+        processFilters(m_filterInputBuffer, m_filterOutputBuffer, beginSamplePos, endSamplePos);
+    } else {
+        auto& oversampler = *m_oversamplers[m_oversamplingShift - 1];
+        const FType* inputChannels[] = {m_filterInputBuffer.left.data(), m_filterInputBuffer.right.data()};
+        auto upBlock = oversampler.processSamplesUp(
+            juce::dsp::AudioBlock<const FType>(inputChannels, 2, beginSamplePos, numSample));
+
+        // the oversampler's own buffer starts at 0,ours at begin like every other buffer
+        const size_t upBegin = beginSamplePos << m_oversamplingShift;
+        const size_t upEnd = endSamplePos << m_oversamplingShift;
+        const auto numUpSamples = static_cast<int>(upEnd - upBegin);
+        juce::FloatVectorOperations::copy(m_oversampledInput.left.data() + upBegin, upBlock.getChannelPointer(0), numUpSamples);
+        juce::FloatVectorOperations::copy(m_oversampledInput.right.data() + upBegin, upBlock.getChannelPointer(1), numUpSamples);
+        m_oversampledInput.isMono = m_filterInputBuffer.isMono;
+
+        processFilters(m_oversampledInput, m_oversampledOutput, upBegin, upEnd);
+
+        juce::FloatVectorOperations::copy(upBlock.getChannelPointer(0), m_oversampledOutput.left.data() + upBegin, numUpSamples);
+        juce::FloatVectorOperations::copy(upBlock.getChannelPointer(1), m_oversampledOutput.right.data() + upBegin, numUpSamples);
+        FType* outputChannels[] = {m_filterOutputBuffer.left.data(), m_filterOutputBuffer.right.data()};
+        juce::dsp::AudioBlock<FType> outputBlock(outputChannels, 2, beginSamplePos, numSample);
+        oversampler.processSamplesDown(outputBlock);
+        m_filterOutputBuffer.isMono = m_oversampledOutput.isMono;
+    }
 
-    // Filter process
-    m_currentFilterImpl->process(m_filterInputBuffer, m_filterOutputBuffer, beginSamplePos, endSamplePos);
+    // rang out,the next silent block sleeps and the filters start from rest again
+    if (m_silence.update(isInputSilent, m_filterOutputBuffer, beginSamplePos, endSamplePos)) {
+        for (auto& f : m_allFilters) {
+            f->reset();
+        }
+        for (auto& o : m_oversamplers) {
+            o->reset();
+        }
+        m_fadingOutFilterIndex = -1;
+    }
 
     // Mix final output
+    m_processorOutputBuffer.isMono &= m_filterOutputBuffer.isMono;
     juce::FloatVectorOperations::add(m_processorOutputBuffer.left.data() + beginSamplePos,
                                      m_filterOutputBuffer.left.data() + beginSamplePos,
                                      numSample);
     juce::FloatVectorOperations::add(m_processorOutputBuffer.right.data() + beginSamplePos,
                                      m_filterOutputBuffer.right.data() + beginSamplePos,
                                      numSample);
+    applyRateFade(beginSamplePos, endSamplePos);
+}
+
+void MainFilter::applyRateFade(size_t begin, size_t end) {
+    if (m_rateFadeDirection == 0) return;
+
+    const FType step = static_cast<FType>(1) / static_cast<FType>(m_crossfadeLength);
+    for (size_t i = begin; i < end; i++) {
+        if (m_rateFadeDirection < 0 && m_rateFadePosition > 0) {
+            m_rateFadePosition--;
+        } else if (m_rateFadeDirection > 0 && m_rateFadePosition < m_crossfadeLength) {
+            m_rateFadePosition++;
+        }
+        const FType gain = step * static_cast<FType>(m_rateFadePosition);
+        m_processorOutputBuffer.left[i] *= gain;
+        m_processorOutputBuffer.right[i] *= gain;
+    }
+    if (m_rateFadeDirection > 0 && m_rateFadePosition >= m_crossfadeLength) {
+        m_rateFadeDirection = 0;
+    }
+}
+
+void MainFilter::processFilters(StereoBuffer& input, StereoBuffer& output, size_t begin, size_t end) {
+    // only the active filter unless a crossfade is running
+    m_allFilters[m_activeFilterIndex]->process(input, output, begin, end);
+    if (m_fadingOutFilterIndex < 0) return;
+
+    m_allFilters[m_fadingOutFilterIndex]->process(input, m_fadingOutOutputBuffer, begin, end);
+
+    // crossfade length is in samples of the current rate
+    const size_t crossfadeLength = m_crossfadeLength << m_oversamplingShift;
+    const FType step = static_cast<FType>(1) / static_cast<FType>(crossfadeLength);
+    for (size_t i = begin; i < end && m_crossfadePosition < crossfadeLength; i++) {
+        const FType gain = step * static_cast<FType>(++m_crossfadePosition);
+        output.left[i] = m_fadingOutOutputBuffer.left[i]
+            + (output.left[i] - m_fadingOutOutputBuffer.left[i]) * gain;
+        output.right[i] = m_fadingOutOutputBuffer.right[i]
+            + (output.right[i] - m_fadingOutOutputBuffer.right[i]) * gain;
+    }
+    if (m_crossfadePosition >= crossfadeLength) {
+        m_fadingOutFilterIndex = -1;
+    }
+}
+
+void MainFilter::delayBypassedInputs(size_t begin, size_t end) {
+    const size_t latency = m_latencySamples.load(std::memory_order_relaxed);
+    if (latency == 0) return;
+
+    // the delayed samples came from the last block too,mono only if both were
+    const bool isMono = m_processorOutputBuffer.isMono;
+    m_processorOutputBuffer.isMono &= m_wasBypassMono;
+    m_wasBypassMono = isMono;
+
+    for (size_t i = begin; i < end; i++) {
+        const size_t readPos = (m_bypassDelayWritePos - latency) & m_bypassDelayMask;
+        m_bypassDelayLine.left[m_bypassDelayWritePos] = m_processorOutputBuffer.left[i];
+        m_bypassDelayLine.right[m_bypassDelayWritePos] = m_processorOutputBuffer.right[i];
+        m_processorOutputBuffer.left[i] = m_bypassDelayLine.left[readPos];
+        m_processorOutputBuffer.right[i] = m_bypassDelayLine.right[readPos];
+        m_bypassDelayWritePos = (m_bypassDelayWritePos + 1) & m_bypassDelayMask;
+    }
+}
+
+void MainFilter::setOversamplingShift(size_t shift) {
+    shift = juce::jmin(shift, kMaxOversamplingShift);
+    if (shift == m_oversamplingShift) return;
+
+    // a new rate,the oversampler starts from silence and a running crossfade ends.
+    // The output is silent here,so neither that nor the new latency clicks
+    m_oversamplingShift = shift;
+    for (auto& f : m_allFilters) {
+        f->setOversamplingShift(shift);
+    }
+    if (shift > 0) {
+        m_oversamplers[shift - 1]->reset();
+    }
+    m_fadingOutFilterIndex = -1;
+    m_bypassDelayLine.clear();
+    m_latencySamples.store(shift > 0 ? static_cast<size_t>(m_oversamplers[shift - 1]->getLatencyInSamples()) : 0,
+                           std::memory_order_relaxed);
 }
 
 void MainFilter::saveExtraState(juce::XmlElement& xml) {
     auto* filterXML = xml.createNewChildElement(getProcessorID());
-    filterXML->setAttribute(kFilterNameAttribute, m_newFilterName);
+    filterXML->setAttribute(kFilterNameAttribute, getCurrentFilterName());
 }
 
 void MainFilter::loadExtraState(juce::XmlElement& xml, juce::AudioProcessorValueTreeState& /*apvts*/) {
@@ -162,19 +352,19 @@ void MainFilter::loadExtraState(juce::XmlElement& xml, juce::AudioProcessorValue
 }
 
 void MainFilter::changeFilter(const juce::String& filterType) {
-    // Just return if filter name is same
-    if (filterType == m_currentFilterImpl->getFilterName()) {
+    // Do not contain this filter,also do nothing
+    const int index = findFilterIndex(filterType);
+    if (index < 0) {
         return;
     }
 
-    // Do not contain this filter,also do nothing
-    if (!m_allFilters.contains(filterType)) {
+    // Just return if filter name is same
+    if (index == m_selectedFilterIndex.load(std::memory_order_relaxed)) {
         return;
     }
 
-    // set flag true,and changed it on audio thread
-    m_newFilterName = filterType;
-    m_isFilterChanged = true;
+    // changed on audio thread
+    m_selectedFilterIndex.store(index, std::memory_order_relaxed);
 
     // notify ui
     if (onFilterTypeChange) {
@@ -188,21 +378,48 @@ void MainFilter::addAudioInput(AudioProcessorBase* pProcessor, StereoBuffer* pIn
     m_inputRouter.emplace_back(pProcessor, pInput, nullptr);
 }
 
+void MainFilter::setAudioInputBuffer(AudioProcessorBase* pProcessor, StereoBuffer* pInput) {
+    jassert(pInput != nullptr);
+    for (auto& set : m_inputRouter) {
+        if (set.pProcessor == pProcessor) {
+            set.pProcessOutputBuffer = pInput;
+            return;
+        }
+    }
+    jassertfalse;
+}
+
 juce::StringArray MainFilter::getAllFilterNames() const {
     juce::StringArray s;
-    for (auto f : m_allFilters) {
+    for (auto& f : m_allFilters) {
         s.add(f->getFilterName());
     }
     return s;
 }
 
 juce::StringRef MainFilter::getCurrentFilterName() const {
-    return m_newFilterName;
+    return m_allFilters[m_selectedFilterIndex.load(std::memory_order_relaxed)]->getFilterName();
 }
 
 void MainFilter::doLayout(ui::FilterKnobsPanel& p, const juce::String& name) {
-    if (!m_allFilters.contains(name)) return;
+    const int index = findFilterIndex(name);
+    if (index < 0) return;
+
+    m_allFilters[index]->doLayout(p);
+}
 
-    m_allFilters.getReference(name)->doLayout(p);
+size_t MainFilter::getRequestedOversamplingShift() const {
+    if (m_oversamplingParameter == nullptr) return m_oversamplingShift;
+    return static_cast<size_t>(m_oversamplingParameter->getIndex());
+}
+
+int MainFilter::findFilterIndex(const juce::String& filterType) const {
+    for (int i = 0; auto& f : m_allFilters) {
+        if (f->getFilterName() == filterType) {
+            return i;
+        }
+        i++;
+    }
+    return -1;
 }
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #pragma once
 #include "synthesizer/AudioProcessorBase.h"
+#include "synthesizer/utils/SilenceTracker.h"
 
 namespace rpSynth::audio::filters {
 class FilterImplBase;
@@ -23,6 +24,11 @@ class FilterKnobsPanel;
 namespace rpSynth::audio {
 class MainFilter : public AudioProcessorBase {
 public:
+    // outgoing and incoming filter both run for this long after a change
+    static constexpr FType kCrossfadeTimeInSeconds = static_cast<FType>(0.02);
+    // up to 2^3 = 8x oversampling
+    static constexpr size_t kMaxOversamplingShift = 3;
+
     struct InputRouterSet {
         AudioProcessorBase* pProcessor = nullptr;
         StereoBuffer* pProcessOutputBuffer = nullptr;
@@ -49,12 +55,19 @@ public:
     //=========================================================================
     void changeFilter(const juce::String& filterType);
     void addAudioInput(AudioProcessorBase* pProcessor, StereoBuffer* pInput);
+    // Read a added input from another buffer,not thread-safe,call it in prepare
+    void setAudioInputBuffer(AudioProcessorBase* pProcessor, StereoBuffer* pInput);
     StereoBuffer* getFilterOutput() { return &m_processorOutputBuffer; }
     juce::StringArray getAllFilterNames() const;
     juce::StringRef getCurrentFilterName() const;
     const InputRouterSet& getInputSet(size_t index) const { return m_inputRouter[index]; }
     size_t getNumInputs() const { return m_inputRouter.size(); }
     void doLayout(ui::FilterKnobsPanel&, const juce::String& name);
+
+    /**
+     * @brief Latency of the oversampler in use,changes with the oversampling parameter
+    */
+    size_t getLatencySamples() const { return m_latencySamples.load(std::memory_order_relaxed); }
     //=========================================================================
 
     //=========================================================================
@@ -63,9 +76,52 @@ public:
 private:
     //=========================================================================
     // filter changing
-    std::shared_ptr<filters::FilterImplBase> m_currentFilterImpl;
-    std::atomic<bool> m_isFilterChanged = false;
-    juce::String m_newFilterName;
+    int findFilterIndex(const juce::String& filterType) const;
+
+    // written on message thread,picked up by the audio thread when no crossfade is running
+    std::atomic<int> m_selectedFilterIndex = 0;
+
+    // audio thread only
+    int m_activeFilterIndex = 0;
+    int m_fadingOutFilterIndex = -1;
+    size_t m_crossfadeLength = 0;
+    size_t m_crossfadePosition = 0;
+    StereoBuffer m_fadingOutOutputBuffer;
+
+    // active filter,and the outgoing one while a crossfade runs
+    void processFilters(StereoBuffer& input, StereoBuffer& output, size_t begin, size_t end);
+    //=========================================================================
+
+    //=========================================================================
+    // oversampling around the filters,selected per patch
+    // switches at once,call it only while the output is silent
+    void setOversamplingShift(size_t shift);
+    size_t getRequestedOversamplingShift() const;
+
+    // a new rate fades the output out,switches at silence and fades back in
+    void applyRateFade(size_t begin, size_t end);
+    size_t m_rateFadePosition = 0;
+    int m_rateFadeDirection = 0;
+
+    juce::AudioParameterChoice* m_oversamplingParameter = nullptr;
+    // index shift - 1,all made on constructor so switching never allocates
+    std::array<std::unique_ptr<juce::dsp::Oversampling<FType>>, kMaxOversamplingShift> m_oversamplers;
+    size_t m_oversamplingShift = 0;
+    std::atomic<size_t> m_latencySamples = 0;
+    StereoBuffer m_oversampledInput;
+    StereoBuffer m_oversampledOutput;
+
+    // bypassed inputs are delayed by the same latency,so they stay aligned with the filtered ones
+    void delayBypassedInputs(size_t begin, size_t end);
+    StereoBuffer m_bypassDelayLine;
+    size_t m_bypassDelayMask = 0;
+    size_t m_bypassDelayWritePos = 0;
+    bool m_wasBypassMono = true;
+    //=========================================================================
+
+    //=========================================================================
+    // sleeping while every input is silent and the filter rang out
+    SilenceTracker m_silence;
     //=========================================================================
 
     //=========================================================================
@@ -77,8 +133,8 @@ private:
     //=========================================================================
 
     //=========================================================================
-    // All types of filters
-    juce::HashMap<juce::String, std::shared_ptr<filters::FilterImplBase>> m_allFilters;
+    // All types of filters,fixed after the constructor and indexed by m_selectedFilterIndex
+    std::vector<std::shared_ptr<filters::FilterImplBase>> m_allFilters;
     //=========================================================================
 
 public:
@@ -9,36 +9,306 @@
 */
 
 #include "PolyOscillor.h"
+#include "../utils/PitchKernels.h"
+#include "../modulation/ModulatorBase.h"
 
 namespace rpSynth::audio {
+static const juce::String kPolyphonyAttribute = "polyphony";
+static const juce::String kStealPolicyAttribute = "stealPolicy";
+
+// below this dispatching costs more than it saves
+static constexpr size_t kMinGroupsForWorkers = 2;
+static constexpr size_t kMinSamplesForWorkers = 32;
+
+static_assert(VoiceBank::kMaxVoices == kMaxModulatorVoices, "every voice needs a modulator state");
+static_assert(VoiceBank::kNumLanes == kModulatorVoiceGroupSize, "voice groups must match");
+
 void PolyOscillor::prepare(FType sampleRate, size_t numSamples) {
-    // Output buffer init here
-    m_outputBuffer.left.resize(numSamples, FType{});
-    m_outputBuffer.right.resize(numSamples, FType{});
+    // Output buffer init here,it holds a whole span
+    m_microBlockSize = numSamples;
+    const size_t numSpanSamples = numSamples * m_numMicroBlocksPerSpan;
+    m_outputBuffer.left.resize(numSpanSamples, FType{});
+    m_outputBuffer.right.resize(numSpanSamples, FType{});
+    m_outputBuffer.isMono = true;
+    m_isMicroBlockSilent.assign(m_numMicroBlocksPerSpan, 1);
+    m_spanOffset = 0;
 
     // Oscillor init here
-    for (SingeNoteOscillor& osc : m_SingleNoteOscillors) {
-        osc.prepare(sampleRate, numSamples);
-        osc.m_parentOscillor = this;
+    m_sampleRate = sampleRate;
+    m_baseIncrement.resize(numSpanSamples, FType{});
+    m_volumeGain.resize(numSpanSamples, FType{1});
+    m_filterCutoffBuffer.resize(numSpanSamples);
+    m_filterResonanceBuffer.resize(numSpanSamples);
+    m_filterBlock.oneDivNyquistRate = static_cast<FType>(2) / sampleRate;
+
+    // twice the segments of a span,so short ranges between midi events rarely render early
+    const size_t numSegments = (numSpanSamples + VoiceBank::kFilterInterval - 1) / VoiceBank::kFilterInterval;
+    m_maxPendingSegments = numSegments * 2;
+    m_pendingRanges.resize(m_maxPendingSegments);
+    m_numPendingRanges = 0;
+    m_numPendingSegments = 0;
+    m_voicePitchRatio.resize(m_maxPendingSegments * VoiceBank::kMaxVoices, FType{1});
+    m_voiceLevel.resize(m_maxPendingSegments * VoiceBank::kMaxVoices, FType{});
+    m_voiceCutoff.resize(m_maxPendingSegments * VoiceBank::kMaxVoices, FType{});
+    m_voiceResonance.resize(m_maxPendingSegments * VoiceBank::kMaxVoices, FType{});
+    m_voices.resetFilters();
+    for (auto& buffer : m_groupBuffers) {
+        buffer.resize(numSpanSamples);
     }
+    applyVoiceSettings();
 }
 
 void PolyOscillor::process(size_t beginSamplePos, size_t endSamplePos) {
-    // clear
-    clearBuffer();
+    applyVoiceSettings();
+
+    // ranges are in the micro block,buffers of the span start at its offset
+    const size_t spanBegin = m_spanOffset + beginSamplePos;
+    const size_t spanEnd = m_spanOffset + endSamplePos;
+
+    // clear this range only,earlier ranges of the span are already recorded
+    m_outputBuffer.clear(spanBegin, spanEnd);
+    if (!m_voices.hasActiveVoices() || beginSamplePos == endSamplePos) return;
+    m_isMicroBlockSilent[m_spanOffset / m_microBlockSize] = 0;
+
+    // no room for the segments of this range,render what is there first
+    const size_t numSegments = (endSamplePos - beginSamplePos + VoiceBank::kFilterInterval - 1) / VoiceBank::kFilterInterval;
+    if (m_numPendingRanges == m_pendingRanges.size() || m_numPendingSegments + numSegments > m_maxPendingSegments) {
+        renderPendingRanges();
+    }
 
     // adding...
-    for (SingeNoteOscillor& osc : m_SingleNoteOscillors) {
-        osc.addToBlock(m_outputBuffer, beginSamplePos, endSamplePos);
+    const FType incrementOfA = static_cast<FType>(440) / m_sampleRate;
+    if (m_semitone.isConstant()) {
+        const FType increment = kernels::semitoneToHertz(static_cast<FType>(69) + m_semitone.get(beginSamplePos),
+                                                         incrementOfA);
+        std::fill(m_baseIncrement.begin() + spanBegin, m_baseIncrement.begin() + spanEnd, increment);
+    } else {
+        for (size_t i = beginSamplePos; i < endSamplePos; i++) {
+            m_baseIncrement[m_spanOffset + i] = static_cast<FType>(69) + m_semitone.get(i);
+        }
+        kernels::semitoneToHertz(m_baseIncrement.data() + spanBegin,
+                                 m_baseIncrement.data() + spanBegin,
+                                 endSamplePos - beginSamplePos,
+                                 incrementOfA);
+    }
+
+    // the same for every pending range,voices only change after renderPendingRanges
+    m_numActiveGroups = 0;
+    for (size_t group = 0; group < VoiceBank::kNumGroups; group++) {
+        if (m_voices.isGroupActive(group)) {
+            m_activeGroups[m_numActiveGroups++] = group;
+        }
+    }
+
+    const auto* filter = prepareFilterBlock(beginSamplePos, endSamplePos);
+    const auto* modulation = prepareVoiceModulation(beginSamplePos, endSamplePos, m_numActiveGroups, filter != nullptr);
+    auto& range = m_pendingRanges[m_numPendingRanges++];
+    range.begin = spanBegin;
+    range.end = spanEnd;
+    range.hasFilter = filter != nullptr;
+    if (filter != nullptr) range.filter = *filter;
+    range.hasModulation = modulation != nullptr;
+    if (modulation != nullptr) range.modulation = *modulation;
+
+    // volume is already in the level of every voice
+    if (modulation != nullptr) return;
+
+    // Volume of the range
+    if (m_volumeLevel.isConstant()) {
+        const auto level = juce::Decibels::decibelsToGain(m_volumeLevel.get(beginSamplePos),
+                                                          static_cast<FType>(-36));
+        std::fill(m_volumeGain.begin() + spanBegin, m_volumeGain.begin() + spanEnd, level);
+        return;
+    }
+    for (size_t i = beginSamplePos; i < endSamplePos; i++) {
+        m_volumeGain[m_spanOffset + i] = juce::Decibels::decibelsToGain(m_volumeLevel.get(i),
+                                                                        static_cast<FType>(-36));
+    }
+}
+
+void PolyOscillor::renderSpan() {
+    renderPendingRanges();
+}
+
+void PolyOscillor::renderPendingRanges() {
+    if (m_numPendingRanges == 0) return;
+
+    const size_t beginSamplePos = m_pendingRanges[0].begin;
+    const size_t endSamplePos = m_pendingRanges[m_numPendingRanges - 1].end;
+    if (m_useWorkerPool.load(std::memory_order_acquire)
+        && m_numActiveGroups >= kMinGroupsForWorkers
+        && endSamplePos - beginSamplePos >= kMinSamplesForWorkers) {
+        renderVoicesWithWorkers(beginSamplePos, endSamplePos);
+    } else {
+        for (size_t i = 0; i < m_numPendingRanges; i++) {
+            const auto& range = m_pendingRanges[i];
+            m_voices.addToBlock(m_outputBuffer.left.data(), m_outputBuffer.right.data(),
+                                m_baseIncrement.data(), range.begin, range.end,
+                                range.hasFilter ? &range.filter : nullptr,
+                                range.hasModulation ? &range.modulation : nullptr);
+        }
     }
 
     // Apply volume
-    for (; beginSamplePos < endSamplePos; beginSamplePos++) {
-        auto level = juce::Decibels::decibelsToGain(m_volumeLevel.get(beginSamplePos),
-                                                    static_cast<FType>(-36));
-        m_outputBuffer.left[beginSamplePos] *= level;
-        m_outputBuffer.right[beginSamplePos] *= level;
+    for (size_t i = 0; i < m_numPendingRanges; i++) {
+        const auto& range = m_pendingRanges[i];
+        if (range.hasModulation) continue;
+        const auto numSamples = static_cast<int>(range.end - range.begin);
+        juce::FloatVectorOperations::multiply(m_outputBuffer.left.data() + range.begin,
+                                              m_volumeGain.data() + range.begin, numSamples);
+        juce::FloatVectorOperations::multiply(m_outputBuffer.right.data() + range.begin,
+                                              m_volumeGain.data() + range.begin, numSamples);
+    }
+    m_numPendingRanges = 0;
+    m_numPendingSegments = 0;
+    finishReleasedVoices();
+}
+
+const VoiceBank::FilterBlock* PolyOscillor::prepareFilterBlock(size_t beginSamplePos, size_t endSamplePos) {
+    const bool isEnabled = m_filterEnabled != nullptr && m_filterEnabled->get();
+    if (isEnabled && !m_wasFilterEnabled) {
+        // state from the last time it was on would click,the ranges before still use it
+        renderPendingRanges();
+        m_voices.resetFilters();
+    }
+    m_wasFilterEnabled = isEnabled;
+    if (!isEnabled) return nullptr;
+
+    // kept for the whole span,read at the position in the span
+    auto keep = [this, beginSamplePos, endSamplePos](MyAudioProcessParameter& parameter, SampleBuffer& buffer) {
+        FType* dst = buffer.data() + m_spanOffset;
+        const FType* values = parameter.getBlock(beginSamplePos, endSamplePos, dst);
+        if (values != dst) {
+            std::copy(values + beginSamplePos, values + endSamplePos, dst + beginSamplePos);
+        }
+    };
+    keep(m_filterCutoff, m_filterCutoffBuffer);
+    keep(m_filterResonance, m_filterResonanceBuffer);
+    m_filterBlock.cutoff = m_filterCutoffBuffer.data();
+    m_filterBlock.resonance = m_filterResonanceBuffer.data();
+    m_filterBlock.keytrack = m_filterKeytrack.get(beginSamplePos);
+    return &m_filterBlock;
+}
+
+const VoiceBank::VoiceModulationBlock* PolyOscillor::prepareVoiceModulation(size_t beginSamplePos, size_t endSamplePos,
+                                                                            size_t numActiveGroups, bool hasFilter) {
+    if (m_matrix == nullptr || !m_matrix->hasVoiceRoutes()) return nullptr;
+
+    constexpr auto kNumLanes = VoiceBank::kNumLanes;
+    const FType zero{};
+    // after the segments of the pending ranges
+    const size_t firstSegment = m_numPendingSegments;
+    size_t segment = firstSegment;
+    for (size_t segmentBegin = beginSamplePos; segmentBegin < endSamplePos; segment++) {
+        const size_t segmentEnd = juce::jmin(endSamplePos, segmentBegin + VoiceBank::kFilterInterval);
+        const size_t last = segmentEnd - 1;
+        std::ranges::fill(m_voiceOffsets, FType{});
+        m_matrix->processVoices(m_activeGroups.data(), numActiveGroups, last, segmentEnd - segmentBegin,
+                                m_voiceOffsets.data());
+
+        // the unmodulated pitch goes through the same conversion,so no link is no detune
+        FType baseSemitone{};
+        m_semitone.getWithOffsets(last, &zero, &baseSemitone, 1);
+        for (size_t i = 0; i < numActiveGroups; i++) {
+            const size_t first = m_activeGroups[i] * kNumLanes;
+            const size_t index = segment * VoiceBank::kMaxVoices + first;
+            auto offsetsOf = [this, first](VoiceTarget target) {
+                return m_voiceOffsets.data() + target * VoiceBank::kMaxVoices + first;
+            };
+
+            FType* ratio = m_voicePitchRatio.data() + index;
+            m_semitone.getWithOffsets(last, offsetsOf(kVoicePitch), ratio, kNumLanes);
+            FType* level = m_voiceLevel.data() + index;
+            m_volumeLevel.getWithOffsets(last, offsetsOf(kVoiceVolume), level, kNumLanes);
+            for (size_t lane = 0; lane < kNumLanes; lane++) {
+                ratio[lane] = std::exp2((ratio[lane] - baseSemitone) / static_cast<FType>(12));
+                level[lane] = juce::Decibels::decibelsToGain(level[lane], static_cast<FType>(-36));
+            }
+
+            if (hasFilter) {
+                m_filterCutoff.getWithOffsets(last, offsetsOf(kVoiceCutoff), m_voiceCutoff.data() + index, kNumLanes);
+                m_filterResonance.getWithOffsets(last, offsetsOf(kVoiceResonance), m_voiceResonance.data() + index, kNumLanes);
+            }
+        }
+        segmentBegin = segmentEnd;
     }
+    m_numPendingSegments = segment;
+
+    const size_t first = firstSegment * VoiceBank::kMaxVoices;
+    m_voiceModulation = {m_voicePitchRatio.data() + first, m_voiceLevel.data() + first,
+                         m_voiceCutoff.data() + first, m_voiceResonance.data() + first};
+    return &m_voiceModulation;
+}
+
+void PolyOscillor::finishReleasedVoices() {
+    if (m_matrix == nullptr || !m_voices.hasReleasingVoices()) return;
+
+    for (size_t voice = 0; voice < VoiceBank::kMaxVoices; voice++) {
+        if (m_voices.isReleasing(voice) && !m_matrix->isVoiceActive(voice, kVoiceVolume)) {
+            m_voices.finishRelease(voice);
+        }
+    }
+}
+
+void PolyOscillor::connectVoiceTargets(ModulationMatrix& matrix) {
+    m_matrix = &matrix;
+    matrix.addVoiceTarget(m_semitone, kVoicePitch);
+    matrix.addVoiceTarget(m_volumeLevel, kVoiceVolume);
+    matrix.addVoiceTarget(m_filterCutoff, kVoiceCutoff);
+    matrix.addVoiceTarget(m_filterResonance, kVoiceResonance);
+    matrix.rebuild();
+}
+
+void PolyOscillor::beginMicroBlock(size_t index) {
+    jassert(index < m_numMicroBlocksPerSpan);
+    m_spanOffset = index * m_microBlockSize;
+    // silent until a range of this micro block renders a voice
+    m_isMicroBlockSilent[index] = 1;
+}
+
+void PolyOscillor::renderVoicesWithWorkers(size_t beginSamplePos, size_t endSamplePos) {
+    m_jobBeginSamplePos = beginSamplePos;
+    m_jobEndSamplePos = endSamplePos;
+    m_workerPool->run(*this, m_numActiveGroups);
+
+    // sum in group order,the same order addToBlock adds groups,so the result is bit-identical
+    const auto numSamples = static_cast<int>(endSamplePos - beginSamplePos);
+    for (size_t i = 0; i < m_numActiveGroups; i++) {
+        auto& groupBuffer = m_groupBuffers[m_activeGroups[i]];
+        juce::FloatVectorOperations::add(m_outputBuffer.left.data() + beginSamplePos,
+                                         groupBuffer.left.data() + beginSamplePos,
+                                         numSamples);
+        juce::FloatVectorOperations::add(m_outputBuffer.right.data() + beginSamplePos,
+                                         groupBuffer.right.data() + beginSamplePos,
+                                         numSamples);
+    }
+}
+
+void PolyOscillor::runJob(size_t jobIndex) {
+    const auto group = m_activeGroups[jobIndex];
+    auto& groupBuffer = m_groupBuffers[group];
+    const auto numSamples = static_cast<int>(m_jobEndSamplePos - m_jobBeginSamplePos);
+
+    juce::FloatVectorOperations::clear(groupBuffer.left.data() + m_jobBeginSamplePos, numSamples);
+    juce::FloatVectorOperations::clear(groupBuffer.right.data() + m_jobBeginSamplePos, numSamples);
+    // every range of the span for this group,groups do not share state
+    for (size_t i = 0; i < m_numPendingRanges; i++) {
+        const auto& range = m_pendingRanges[i];
+        m_voices.addGroupToBlock(group, groupBuffer.left.data(), groupBuffer.right.data(),
+                                 m_baseIncrement.data(), range.begin, range.end,
+                                 range.hasFilter ? &range.filter : nullptr,
+                                 range.hasModulation ? &range.modulation : nullptr);
+    }
+}
+
+void PolyOscillor::setMultithreadedRendering(bool shouldUseWorkers) {
+    if (shouldUseWorkers && m_workerPool == nullptr) {
+        // the calling thread renders too
+        auto numWorkers = juce::jlimit(1, static_cast<int>(VoiceBank::kNumGroups) - 1,
+                                       juce::SystemStats::getNumCpus() - 1);
+        m_workerPool = std::make_unique<RealtimeWorkerPool>(static_cast<size_t>(numWorkers));
+    }
+    m_useWorkerPool.store(shouldUseWorkers, std::memory_order_release);
 }
 
 void PolyOscillor::clearBuffer() {
@@ -57,53 +327,106 @@ void PolyOscillor::addParameterToLayout(juce::AudioProcessorValueTreeState::Para
                                                                  "volume",
                                                                  juce::NormalisableRange<float>(-36.f, 0.f, 0.1f),
                                                                  -12.f));
+
+    auto pFilterEnabled = std::make_unique<juce::AudioParameterBool>(combineWithID("voiceFilter"),
+                                                                     combineWithID("voiceFilter"),
+                                                                     false);
+    m_filterEnabled = pFilterEnabled.get();
+    layout.add(std::move(pFilterEnabled));
+    layout.add(std::make_unique<MyHostedAudioProcessorParameter>(&m_filterCutoff,
+                                                                 combineWithID("voiceCutoff"),
+                                                                 "voiceCutoff",
+                                                                 juce::NormalisableRange<float>(kStOf20hz, kStOf20000hz, 0.01f),
+                                                                 hertzToSemitone(2000.f),
+                                                                 g_PitchHertzFloatParameterAttribute),
+               std::make_unique<MyHostedAudioProcessorParameter>(&m_filterResonance,
+                                                                 combineWithID("voiceResonance"),
+                                                                 "voiceResonance",
+                                                                 juce::NormalisableRange<float>(0.f, 1.f, 0.01f),
+                                                                 0.f),
+               std::make_unique<MyHostedAudioProcessorParameter>(&m_filterKeytrack,
+                                                                 combineWithID("keytrack"),
+                                                                 "keytrack",
+                                                                 juce::NormalisableRange<float>(0.f, 1.f, 0.01f),
+                                                                 0.f));
 }
 
 void PolyOscillor::updateParameters(size_t numSamples) {
     m_semitone.updateParameter(numSamples);
     m_volumeLevel.updateParameter(numSamples);
+    m_filterCutoff.updateParameter(numSamples);
+    m_filterResonance.updateParameter(numSamples);
+    m_filterKeytrack.updateParameter(numSamples);
 }
 
 void PolyOscillor::prepareParameters(FType sampleRate, size_t numSamples) {
     m_semitone.prepare(sampleRate, numSamples);
     m_volumeLevel.prepare(sampleRate, numSamples);
+    m_filterCutoff.prepare(sampleRate, numSamples);
+    m_filterResonance.prepare(sampleRate, numSamples);
+    m_filterKeytrack.prepare(sampleRate, numSamples);
 }
 
-void PolyOscillor::noteOn(int channel, int noteNumber, float velocity) {
-    for (SingeNoteOscillor& osc : m_SingleNoteOscillors) {
-        if (osc.isPlayingNote(channel, noteNumber)) {
-            osc.stopVoice(velocity, true);
-        }
+void PolyOscillor::noteOn(int /*channel*/, int noteNumber, float velocity) {
+    // the recorded ranges play the voices as they were
+    renderPendingRanges();
+    applyVoiceSettings();
+    const auto voice = m_voices.noteOn(noteNumber, velocity);
+    if (m_matrix != nullptr && voice != VoiceBank::kNoVoice) {
+        m_matrix->voiceOn(static_cast<size_t>(voice));
     }
+}
 
-    for (size_t i = 0; i < kMaxPolyphonic; i++) {
-        SingeNoteOscillor& osc = m_SingleNoteOscillors[m_roundRobinPosition];
-        // find a free oscillor to play
-        if (!osc.isPlaying()) {
-            osc.startVoice(channel, noteNumber, velocity);
-            return;
-        }
+void PolyOscillor::noteOff(int /*channel*/, int noteNumber, float /*velocity*/) {
+    renderPendingRanges();
+    const bool shouldRelease = m_matrix != nullptr && m_matrix->hasVoiceRoutes(kVoiceVolume);
+    const auto voice = m_voices.noteOff(noteNumber, shouldRelease);
+    if (m_matrix == nullptr || voice == VoiceBank::kNoVoice) return;
 
-        m_roundRobinPosition++;
-        m_roundRobinPosition %= kMaxPolyphonic;
+    m_matrix->voiceOff(static_cast<size_t>(voice));
+    if (shouldRelease && !m_matrix->isVoiceActive(static_cast<size_t>(voice), kVoiceVolume)) {
+        m_voices.finishRelease(static_cast<size_t>(voice));
     }
+}
 
-    // all is working,just replace current oscillor
-    SingeNoteOscillor& osc = m_SingleNoteOscillors[m_roundRobinPosition];
-    osc.stopVoice(velocity, false);
-    osc.startVoice(channel, noteNumber, velocity);
-    m_roundRobinPosition++;
-    m_roundRobinPosition %= kMaxPolyphonic;
+void PolyOscillor::setPolyphony(size_t numVoices) {
+    m_polyphony = juce::jlimit<size_t>(1, kMaxPolyphonic, numVoices);
 }
 
-void PolyOscillor::noteOff(int channel, int noteNumber, float velocity) {
-    for (SingeNoteOscillor& osc : m_SingleNoteOscillors) {
-        if (osc.isPlayingNote(channel, noteNumber)) {
-            osc.stopVoice(velocity, true);
-        }
+void PolyOscillor::setStealPolicy(VoiceBank::StealPolicy policy) {
+    m_stealPolicy = policy;
+}
+
+void PolyOscillor::applyVoiceSettings() {
+    m_voices.setStealPolicy(m_stealPolicy);
+
+    if (size_t numVoices = m_polyphony; numVoices != m_voices.getNumVoices()) {
+        renderPendingRanges();
+        m_voices.setNumVoices(numVoices);
     }
 }
 
+void PolyOscillor::saveExtraState(juce::XmlElement& xml) {
+    auto* oscillorXML = xml.createNewChildElement(getProcessorID());
+    oscillorXML->setAttribute(kPolyphonyAttribute, static_cast<int>(getPolyphony()));
+    oscillorXML->setAttribute(kStealPolicyAttribute, static_cast<int>(getStealPolicy()));
+}
+
+void PolyOscillor::loadExtraState(juce::XmlElement& xml, juce::AudioProcessorValueTreeState& /*apvts*/) {
+    auto* oscillorXML = xml.getChildByName(getProcessorID());
+    if (oscillorXML == nullptr) {
+        setPolyphony(kLegacyPolyphonic);
+        setStealPolicy(VoiceBank::StealPolicy::kOldest);
+        return;
+    }
+
+    setPolyphony(static_cast<size_t>(oscillorXML->getIntAttribute(kPolyphonyAttribute,
+                                                                  static_cast<int>(kLegacyPolyphonic))));
+    setStealPolicy(oscillorXML->getIntAttribute(kStealPolicyAttribute) == static_cast<int>(VoiceBank::StealPolicy::kQuietest)
+                   ? VoiceBank::StealPolicy::kQuietest
+                   : VoiceBank::StealPolicy::kOldest);
+}
+
 StereoBuffer* PolyOscillor::getOutputBuffer() {
     return &m_outputBuffer;
 }
@@ -11,38 +11,162 @@
 #pragma once
 
 #include <array>
+#include <vector>
 #include "../../concepts.h"
-#include "SingeNoteOscillor.h"
+#include "VoiceBank.h"
 #include "../WrapParameter.h"
 #include "../AudioProcessorBase.h"
+#include "../utils/RealtimeWorkerPool.h"
 
 namespace rpSynth::audio {
-class PolyOscillor : public AudioProcessorBase {
+class ModulationMatrix;
+
+class PolyOscillor : public AudioProcessorBase, private RealtimeWorkerPool::Job {
 public:
-    static constexpr size_t kMaxPolyphonic = 8;
+    static constexpr size_t kMaxPolyphonic = VoiceBank::kMaxVoices;
+    static constexpr size_t kDefaultPolyphonic = 16;
+    // voice count of presets saved before polyphony was stored
+    static constexpr size_t kLegacyPolyphonic = 8;
+
+    // parameters modulated per voice by polyphonic modulators
+    enum VoiceTarget : size_t {
+        kVoicePitch,
+        kVoiceVolume,
+        kVoiceCutoff,
+        kVoiceResonance,
+        kNumVoiceTargets
+    };
 
     using AudioProcessorBase::AudioProcessorBase;
 
+    /**
+     * @brief Set from message thread,changed on audio thread
+    */
+    void setPolyphony(size_t numVoices);
+    size_t getPolyphony() const { return m_polyphony; }
+    void setStealPolicy(VoiceBank::StealPolicy policy);
+    VoiceBank::StealPolicy getStealPolicy() const { return m_stealPolicy; }
+
+    /**
+     * @brief Render voice groups on a worker pool,output is bit-identical to rendering on one thread.
+     *        Call from message thread,workers are spawned the first time it is enabled.
+    */
+    void setMultithreadedRendering(bool shouldUseWorkers);
+    bool isMultithreadedRendering() const { return m_useWorkerPool; }
+
     void clearBuffer();
+
+    /**
+     * @brief Let matrix modulate the voice parameters per voice and send it note on and off
+     *        of every voice.With a volume link a released voice plays until the link's
+     *        modulators finished,e.g. an envelope's release.
+    */
+    void connectVoiceTargets(ModulationMatrix& matrix);
+
+    /**
+     * @brief Micro blocks rendered together,set it before prepare.Voices are rendered
+     *        once per span,so the worker pool is dispatched once per span as well.
+    */
+    void setNumMicroBlocksPerSpan(size_t numMicroBlocks) { m_numMicroBlocksPerSpan = juce::jmax<size_t>(1, numMicroBlocks); }
+
+    /**
+     * @brief Call before the first process of micro block index of the span,
+     *        process then records the ranges of the micro block one after another
+    */
+    void beginMicroBlock(size_t index);
+
+    /**
+     * @brief Render every range recorded since the last call,
+     *        call it at the end of the span before reading the output
+    */
+    void renderSpan();
     void noteOn(int channel, int noteNumber, float velocity);
     void noteOff(int channel, int noteNumber, float velocity);
 
+    // output of the whole span,micro block index starts at index * micro block size
     StereoBuffer* getOutputBuffer();
+    bool isMicroBlockSilent(size_t index) const { return m_isMicroBlockSilent[index] != 0; }
 
     // implement from AudioProcessorBase
     void addParameterToLayout(juce::AudioProcessorValueTreeState::ParameterLayout& layout) override;
     void updateParameters(size_t numSamples) override;
     void prepareParameters(FType sampleRate, size_t numSamples) override;
+    // numSamlpes is the micro block size,the output holds a span of them
     void prepare(FType sampleRate, size_t numSamlpes) override;
+    // records the range,renderSpan renders it
     void process(size_t beginSamplePos, size_t endSamplePos) override;
-    void saveExtraState(juce::XmlElement& /*xml*/) override {};
-    void loadExtraState(juce::XmlElement& /*xml*/, juce::AudioProcessorValueTreeState& /*apvts*/) override {};
+    void saveExtraState(juce::XmlElement& xml) override;
+    void loadExtraState(juce::XmlElement& xml, juce::AudioProcessorValueTreeState& apvts) override;
 private:
-    friend class SingeNoteOscillor;
+    // a range of the span,with everything its voices read while rendering
+    struct PendingRange {
+        size_t begin = 0;
+        size_t end = 0;
+        bool hasFilter = false;
+        bool hasModulation = false;
+        VoiceBank::FilterBlock filter;
+        VoiceBank::VoiceModulationBlock modulation;
+    };
+
+    void applyVoiceSettings();
+    // voices must not change between the recorded ranges,call it before changing them
+    void renderPendingRanges();
+    void renderVoicesWithWorkers(size_t beginSamplePos, size_t endSamplePos);
+    void runJob(size_t jobIndex) override;
+
+    // voice filter parameters of [begin,end),nullptr while the voice filter is off
+    const VoiceBank::FilterBlock* prepareFilterBlock(size_t beginSamplePos, size_t endSamplePos);
+
+    // modulation of the active voices in [begin,end),nullptr without voice links
+    const VoiceBank::VoiceModulationBlock* prepareVoiceModulation(size_t beginSamplePos, size_t endSamplePos,
+                                                                  size_t numActiveGroups, bool hasFilter);
+    void finishReleasedVoices();
 
     // oscillors
-    std::array<SingeNoteOscillor, kMaxPolyphonic> m_SingleNoteOscillors;
-    size_t m_roundRobinPosition = 0;
+    VoiceBank m_voices;
+    std::atomic<size_t> m_polyphony = kDefaultPolyphonic;
+    std::atomic<VoiceBank::StealPolicy> m_stealPolicy = VoiceBank::StealPolicy::kOldest;
+    FType m_sampleRate{};
+
+    // phase increment of note 69 per sample,shared by all voices
+    SampleBuffer m_baseIncrement;
+
+    // span,every buffer below holds one unless noted
+    size_t m_numMicroBlocksPerSpan = 1;
+    size_t m_microBlockSize = 0;
+    size_t m_spanOffset = 0;
+    std::vector<uint8_t> m_isMicroBlockSilent;
+    std::vector<PendingRange> m_pendingRanges;
+    size_t m_numPendingRanges = 0;
+    size_t m_numPendingSegments = 0;
+    size_t m_maxPendingSegments = 0;
+    size_t m_numActiveGroups = 0;
+
+    // gain of the volume parameter,applied to ranges without voice modulation
+    SampleBuffer m_volumeGain;
+
+    // voice filter
+    VoiceBank::FilterBlock m_filterBlock;
+    bool m_wasFilterEnabled = false;
+    SampleBuffer m_filterCutoffBuffer;
+    SampleBuffer m_filterResonanceBuffer;
+
+    // voice modulation,every buffer holds kMaxVoices values per pending segment
+    ModulationMatrix* m_matrix = nullptr;
+    VoiceBank::VoiceModulationBlock m_voiceModulation;
+    SampleBuffer m_voicePitchRatio;
+    SampleBuffer m_voiceLevel;
+    SampleBuffer m_voiceCutoff;
+    SampleBuffer m_voiceResonance;
+    alignas(16) std::array<FType, kNumVoiceTargets * VoiceBank::kMaxVoices> m_voiceOffsets{};
+
+    // multithreaded rendering,every active group renders into its own buffer
+    std::unique_ptr<RealtimeWorkerPool> m_workerPool;
+    std::atomic<bool> m_useWorkerPool = false;
+    std::array<StereoBuffer, VoiceBank::kNumGroups> m_groupBuffers;
+    std::array<size_t, VoiceBank::kNumGroups> m_activeGroups{};
+    size_t m_jobBeginSamplePos = 0;
+    size_t m_jobEndSamplePos = 0;
 
     // buffer
     StereoBuffer m_outputBuffer;
@@ -50,5 +174,11 @@ public:
     // Parameters
     MyAudioProcessParameter m_semitone;
     MyAudioProcessParameter m_volumeLevel;
+
+    // every voice through its own lowpass,cutoff can follow the note
+    juce::AudioParameterBool* m_filterEnabled = nullptr;
+    MyAudioProcessParameter m_filterCutoff;
+    MyAudioProcessParameter m_filterResonance;
+    MyAudioProcessParameter m_filterKeytrack;
 };
 }
\ No newline at end of file
@@ -0,0 +1,378 @@
+/*
+  ==============================================================================
+
+    VoiceBank.cpp
+    Created: 17 Oct 2026 1:20:15pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#include "VoiceBank.h"
+#include "../utils/PitchKernels.h"
+
+namespace rpSynth::audio {
+VoiceBank::VoiceBank() {
+    m_noteNumber.fill(-1);
+    m_voiceOfNote.fill(kNoVoice);
+    m_olderVoice.fill(kNoVoice);
+    m_newerVoice.fill(kNoVoice);
+    setNumVoices(kMaxVoices);
+}
+
+void VoiceBank::setNumVoices(size_t numVoices) {
+    m_numVoices = juce::jlimit<size_t>(1, kMaxVoices, numVoices);
+
+    for (size_t i = m_numVoices; i < kMaxVoices; i++) {
+        stopVoice(i);
+    }
+
+    // rebuild free list,lower voices on top so playing voices stay in few SIMD groups
+    m_numFreeVoices = 0;
+    for (size_t i = m_numVoices; i-- > 0;) {
+        if (!isPlaying(i)) {
+            m_freeVoices[m_numFreeVoices++] = i;
+        }
+    }
+}
+
+int VoiceBank::noteOn(int noteNumber, float velocity) {
+    if (noteNumber < 0 || noteNumber >= static_cast<int>(kNumMidiNotes)) return kNoVoice;
+
+    size_t voice = 0;
+    if (m_voiceOfNote[noteNumber] != kNoVoice) {
+        // retrigger
+        voice = static_cast<size_t>(m_voiceOfNote[noteNumber]);
+    } else if (m_numFreeVoices != 0) {
+        voice = m_freeVoices[--m_numFreeVoices];
+    } else {
+        voice = m_stealPolicy == StealPolicy::kOldest
+            ? static_cast<size_t>(m_oldestVoice)
+            : findQuietestVoice();
+    }
+
+    startVoice(voice, noteNumber, velocity);
+    return static_cast<int>(voice);
+}
+
+int VoiceBank::noteOff(int noteNumber, bool shouldRelease) {
+    if (noteNumber < 0 || noteNumber >= static_cast<int>(kNumMidiNotes)) return kNoVoice;
+
+    auto voice = m_voiceOfNote[noteNumber];
+    if (voice == kNoVoice) return kNoVoice;
+
+    if (shouldRelease) {
+        m_voiceOfNote[noteNumber] = kNoVoice;
+        m_isReleasing[voice] = true;
+        m_numReleasingVoices++;
+        return voice;
+    }
+
+    stopVoice(static_cast<size_t>(voice));
+    m_freeVoices[m_numFreeVoices++] = static_cast<size_t>(voice);
+    return voice;
+}
+
+void VoiceBank::finishRelease(size_t voice) {
+    if (!m_isReleasing[voice]) return;
+
+    stopVoice(voice);
+    m_freeVoices[m_numFreeVoices++] = voice;
+}
+
+void VoiceBank::startVoice(size_t voice, int noteNumber, float velocity) {
+    if (isPlaying(voice)) {
+        // a releasing voice does not own its note any more
+        if (m_voiceOfNote[m_noteNumber[voice]] == static_cast<int>(voice)) {
+            m_voiceOfNote[m_noteNumber[voice]] = kNoVoice;
+        }
+        if (m_isReleasing[voice]) {
+            m_isReleasing[voice] = false;
+            m_numReleasingVoices--;
+        }
+        removeFromAgeList(voice);
+    } else {
+        m_numActiveInGroup[voice / kNumLanes]++;
+        m_numActiveVoices++;
+    }
+
+    m_noteNumber[voice] = noteNumber;
+    m_voiceOfNote[noteNumber] = static_cast<int>(voice);
+    appendToAgeList(voice);
+
+    m_gain[voice] = velocity;
+    m_filters[voice / kNumLanes].resetLane(voice % kNumLanes);
+    m_isFilterCoefficientValid[voice] = false;
+    m_isModulationValid[voice] = false;
+    // the pitch of a voice is a ratio to note 69,so the block only needs one pow per sample
+    m_pitchRatio[voice] = std::exp2((static_cast<FType>(noteNumber) - static_cast<FType>(69))
+                                    / static_cast<FType>(12));
+}
+
+void VoiceBank::stopVoice(size_t voice) {
+    if (!isPlaying(voice)) return;
+
+    m_numActiveInGroup[voice / kNumLanes]--;
+    m_numActiveVoices--;
+    if (m_voiceOfNote[m_noteNumber[voice]] == static_cast<int>(voice)) {
+        m_voiceOfNote[m_noteNumber[voice]] = kNoVoice;
+    }
+    if (m_isReleasing[voice]) {
+        m_isReleasing[voice] = false;
+        m_numReleasingVoices--;
+    }
+    m_noteNumber[voice] = -1;
+    m_gain[voice] = FType{};
+    removeFromAgeList(voice);
+}
+
+void VoiceBank::removeFromAgeList(size_t voice) {
+    auto older = m_olderVoice[voice];
+    auto newer = m_newerVoice[voice];
+
+    if (older != kNoVoice) m_newerVoice[older] = newer;
+    else m_oldestVoice = newer;
+
+    if (newer != kNoVoice) m_olderVoice[newer] = older;
+    else m_newestVoice = older;
+
+    m_olderVoice[voice] = kNoVoice;
+    m_newerVoice[voice] = kNoVoice;
+}
+
+void VoiceBank::appendToAgeList(size_t voice) {
+    m_olderVoice[voice] = m_newestVoice;
+    m_newerVoice[voice] = kNoVoice;
+
+    if (m_newestVoice != kNoVoice) m_newerVoice[m_newestVoice] = static_cast<int>(voice);
+    else m_oldestVoice = static_cast<int>(voice);
+
+    m_newestVoice = static_cast<int>(voice);
+}
+
+size_t VoiceBank::findQuietestVoice() const {
+    // only called when every voice is playing,ties go to the older voice
+    size_t quietest = static_cast<size_t>(m_oldestVoice);
+    for (auto voice = m_oldestVoice; voice != kNoVoice; voice = m_newerVoice[voice]) {
+        if (m_gain[voice] < m_gain[quietest]) {
+            quietest = static_cast<size_t>(voice);
+        }
+    }
+    return quietest;
+}
+
+void VoiceBank::resetFilters() {
+    for (auto& f : m_filters) {
+        f.reset();
+    }
+    m_isFilterCoefficientValid.fill(false);
+}
+
+void VoiceBank::calcFilterCoefficients(size_t group, const FilterBlock& filter, size_t pos,
+                                       const VoiceModulationBlock* modulation, size_t segment,
+                                       FloatLane& ctof, FloatLane& feedback) const {
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> laneCtof;
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> laneFeedback;
+    for (size_t lane = 0; lane < kNumLanes; lane++) {
+        const size_t voice = group * kNumLanes + lane;
+        const FType cutoff = modulation != nullptr ? modulation->cutoff[segment * kMaxVoices + voice] : filter.cutoff[pos];
+        const FType resonance = modulation != nullptr ? modulation->resonance[segment * kMaxVoices + voice] : filter.resonance[pos];
+        const FType note = isPlaying(voice) ? static_cast<FType>(m_noteNumber[voice]) : kFilterKeytrackCenter;
+        const FType hz = kernels::semitoneToHertz(cutoff + filter.keytrack * (note - kFilterKeytrackCenter));
+        laneCtof[lane] = juce::jmin(hz * filter.oneDivNyquistRate, kFilterMaxCutoff);
+        laneFeedback[lane] = resonance + resonance / (static_cast<FType>(1) - laneCtof[lane]);
+    }
+    ctof = FloatLane::load(laneCtof.data());
+    feedback = FloatLane::load(laneFeedback.data());
+}
+
+void VoiceBank::calcModulatedVoices(size_t group, const VoiceModulationBlock& modulation, size_t segment,
+                                    FType* ratio, FType* gain) const {
+    const size_t offset = group * kNumLanes;
+    const size_t index = segment * kMaxVoices + offset;
+    (FloatLane::load(m_pitchRatio.data() + offset) * FloatLane::load(modulation.pitchRatio + index)).store(ratio);
+    (FloatLane::load(m_gain.data() + offset) * FloatLane::load(modulation.level + index)).store(gain);
+}
+
+void VoiceBank::addToBlock(FType* left, FType* right, const FType* baseIncrement,
+                           size_t beginSamplePos, size_t endSamplePos,
+                           const FilterBlock* filter, const VoiceModulationBlock* modulation) {
+    for (size_t group = 0; group < kNumGroups; group++) {
+        if (!isGroupActive(group)) continue;
+        addGroupToBlock(group, left, right, baseIncrement, beginSamplePos, endSamplePos, filter, modulation);
+    }
+}
+
+void VoiceBank::addGroupToBlock(size_t group, FType* left, FType* right, const FType* baseIncrement,
+                                size_t beginSamplePos, size_t endSamplePos,
+                                const FilterBlock* filter, const VoiceModulationBlock* modulation) {
+    if (beginSamplePos == endSamplePos) return;
+
+    const auto one = Lane::expand(static_cast<FType>(1));
+    const auto nyquist = Lane::expand(static_cast<FType>(0.5));
+    const MipMappedWaveTable& table = m_waveTables->getSaw();
+
+    const size_t offset = group * kNumLanes;
+    const size_t numSegments = (endSamplePos - beginSamplePos + kFilterInterval - 1) / kFilterInterval;
+    auto phase = Lane::fromRawArray(m_phase.data() + offset);
+    auto ratio = Lane::fromRawArray(m_pitchRatio.data() + offset);
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> gain;
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> lanePhase;
+    std::copy_n(m_gain.data() + offset, kNumLanes, gain.data());
+
+    // new notes start at the modulation of their first segment
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> targetRatio;
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> targetGain;
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> maxRatio;
+    ratio.copyToRawArray(maxRatio.data());
+    if (modulation != nullptr) {
+        calcModulatedVoices(group, *modulation, 0, targetRatio.data(), targetGain.data());
+        for (size_t lane = 0; lane < kNumLanes; lane++) {
+            if (!m_isModulationValid[offset + lane]) {
+                m_modulatedRatio[offset + lane] = targetRatio[lane];
+                m_modulatedGain[offset + lane] = targetGain[lane];
+                m_isModulationValid[offset + lane] = true;
+            }
+        }
+        ratio = Lane::fromRawArray(m_modulatedRatio.data() + offset);
+        std::copy_n(m_modulatedGain.data() + offset, kNumLanes, gain.data());
+
+        ratio.copyToRawArray(maxRatio.data());
+        for (size_t segment = 0; segment < numSegments; segment++) {
+            calcModulatedVoices(group, *modulation, segment, targetRatio.data(), targetGain.data());
+            for (size_t lane = 0; lane < kNumLanes; lane++) {
+                maxRatio[lane] = juce::jmax(maxRatio[lane], targetRatio[lane]);
+            }
+        }
+    }
+
+    // mip level of every voice is chosen once per block from the highest pitch in it
+    const FType maxBaseIncrement = *std::max_element(baseIncrement + beginSamplePos, baseIncrement + endSamplePos);
+    std::array<MipMappedWaveTable::LevelMix, kNumLanes> levelMix;
+    for (size_t lane = 0; lane < kNumLanes; lane++) {
+        levelMix[lane] = table.getLevelMix(juce::jmin(maxRatio[lane] * maxBaseIncrement,
+                                                      static_cast<FType>(0.5)));
+    }
+
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> voiceSample;
+    auto renderVoices = [&](size_t i) {
+        // table reads are per lane,free voices in this group have zero gain
+        phase.copyToRawArray(lanePhase.data());
+        for (size_t lane = 0; lane < kNumLanes; lane++) {
+            const auto& mix = levelMix[lane];
+            const FType lower = mix.lower->read(lanePhase[lane]);
+            const FType upper = mix.upper->read(lanePhase[lane]);
+            voiceSample[lane] = (lower + mix.fraction * (upper - lower)) * gain[lane];
+        }
+
+        // increment never exceeds nyquist,so phase only wraps once
+        phase += Lane::min(ratio * baseIncrement[i], nyquist);
+        phase -= one & Lane::greaterThanOrEqual(phase, one);
+    };
+
+    if (filter == nullptr && modulation == nullptr) {
+        for (size_t i = beginSamplePos; i < endSamplePos; i++) {
+            renderVoices(i);
+            FType sum{};
+            for (size_t lane = 0; lane < kNumLanes; lane++) {
+                sum += voiceSample[lane];
+            }
+            left[i] += sum;
+            right[i] += sum;
+        }
+        phase.copyToRawArray(m_phase.data() + offset);
+        return;
+    }
+
+    // new notes start at the coefficients of their first segment
+    FloatLane ctof;
+    FloatLane feedback;
+    if (filter != nullptr) {
+        calcFilterCoefficients(group, *filter, juce::jmin(endSamplePos, beginSamplePos + kFilterInterval) - 1,
+                               modulation, 0, ctof, feedback);
+        for (size_t voice = offset; voice < offset + kNumLanes; voice++) {
+            if (!m_isFilterCoefficientValid[voice]) {
+                const size_t lane = voice - offset;
+                alignas(Lane::SIMDRegisterSize) std::array<FType, kNumLanes> values;
+                ctof.store(values.data());
+                m_filterCtof[voice] = values[lane];
+                feedback.store(values.data());
+                m_filterFeedback[voice] = values[lane];
+                m_isFilterCoefficientValid[voice] = true;
+            }
+        }
+        ctof = FloatLane::load(m_filterCtof.data() + offset);
+        feedback = FloatLane::load(m_filterFeedback.data() + offset);
+    }
+
+    auto& voiceFilter = m_filters[group];
+    const auto limit = FloatLane::expand(kFilterLimitVolume);
+    const auto oneMinusK = FloatLane::expand(static_cast<FType>(1) - kFilterLimitK);
+    size_t segment = 0;
+    for (size_t segmentBegin = beginSamplePos; segmentBegin < endSamplePos; segment++) {
+        const size_t segmentEnd = juce::jmin(endSamplePos, segmentBegin + kFilterInterval);
+        const FType oneDivNumSamples = static_cast<FType>(1) / static_cast<FType>(segmentEnd - segmentBegin);
+
+        auto ratioStep = Lane::expand(FType{});
+        std::array<FType, kNumLanes> gainStep{};
+        if (modulation != nullptr) {
+            calcModulatedVoices(group, *modulation, segment, targetRatio.data(), targetGain.data());
+            ratioStep = (Lane::fromRawArray(targetRatio.data()) - ratio) * Lane::expand(oneDivNumSamples);
+            for (size_t lane = 0; lane < kNumLanes; lane++) {
+                gainStep[lane] = (targetGain[lane] - gain[lane]) * oneDivNumSamples;
+            }
+        }
+
+        FloatLane targetCtof{};
+        FloatLane targetFeedback{};
+        FloatLane ctofStep{};
+        FloatLane feedbackStep{};
+        if (filter != nullptr) {
+            calcFilterCoefficients(group, *filter, segmentEnd - 1, modulation, segment, targetCtof, targetFeedback);
+            ctofStep = (targetCtof - ctof) * FloatLane::expand(oneDivNumSamples);
+            feedbackStep = (targetFeedback - feedback) * FloatLane::expand(oneDivNumSamples);
+        }
+
+        for (size_t i = segmentBegin; i < segmentEnd; i++) {
+            if (modulation != nullptr) {
+                ratio += ratioStep;
+                for (size_t lane = 0; lane < kNumLanes; lane++) {
+                    gain[lane] += gainStep[lane];
+                }
+            }
+            renderVoices(i);
+
+            FType sum{};
+            if (filter != nullptr) {
+                ctof += ctofStep;
+                feedback += feedbackStep;
+                sum = voiceFilter.LPF2_ResoLimit_limit(FloatLane::load(voiceSample.data()),
+                                                       ctof, feedback, limit, oneMinusK).sum();
+            } else {
+                sum = FloatLane::load(voiceSample.data()).sum();
+            }
+            left[i] += sum;
+            right[i] += sum;
+        }
+
+        // land exactly on the targets,so ramps do not drift
+        if (modulation != nullptr) {
+            ratio = Lane::fromRawArray(targetRatio.data());
+            gain = targetGain;
+        }
+        ctof = targetCtof;
+        feedback = targetFeedback;
+        segmentBegin = segmentEnd;
+    }
+
+    if (filter != nullptr) {
+        ctof.store(m_filterCtof.data() + offset);
+        feedback.store(m_filterFeedback.data() + offset);
+    }
+    if (modulation != nullptr) {
+        ratio.copyToRawArray(m_modulatedRatio.data() + offset);
+        std::copy_n(gain.data(), kNumLanes, m_modulatedGain.data() + offset);
+    }
+    phase.copyToRawArray(m_phase.data() + offset);
+}
+}
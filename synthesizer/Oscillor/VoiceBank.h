@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    VoiceBank.h
+    Created: 17 Oct 2026 1:20:15pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <array>
+#include <JuceHeader.h>
+
+#include "../../concepts.h"
+#include "WaveTable.h"
+#include "../Filter/Filters/LaneFilter.h"
+
+namespace rpSynth::audio {
+/**
+ * @brief All voices of a PolyOscillor,stored as structure of arrays.
+ *        Voices are rendered kNumLanes at a time in one SIMD register,
+ *        a group of lanes without any playing voice costs nothing.
+*/
+class VoiceBank {
+public:
+    using Lane = juce::dsp::SIMDRegister<FType>;
+    static constexpr size_t kNumLanes = Lane::SIMDNumElements;
+    static constexpr size_t kMaxVoices = 64;
+    static constexpr size_t kNumMidiNotes = 128;
+    static constexpr size_t kNumGroups = kMaxVoices / kNumLanes;
+    static_assert(kMaxVoices % kNumLanes == 0, "voices must fill whole SIMD registers");
+    static_assert(kNumLanes == FloatLane::kNumElements, "a voice group is filtered in one FloatLane");
+
+    //================================================================================
+    // Lowpass of every voice,LowPass's filter with one voice in every lane.
+    // Coefficients are computed every kFilterInterval samples and linear between,
+    // modulation of every voice follows the same segments.
+    static constexpr size_t kFilterInterval = 16;
+    static constexpr FType kFilterMaxCutoff = static_cast<FType>(0.95); // part of nyquist
+    static constexpr FType kFilterLimitVolume = static_cast<FType>(1);
+    static constexpr FType kFilterLimitK = static_cast<FType>(0.125);
+    static constexpr FType kFilterKeytrackCenter = static_cast<FType>(60);
+
+    /**
+     * @brief Voice filter parameters of a block,read at [i] like the other buffers
+    */
+    struct FilterBlock {
+        const FType* cutoff = nullptr;     // semitone at note kFilterKeytrackCenter
+        const FType* resonance = nullptr;
+        FType keytrack{};                  // 1 moves cutoff with the note
+        FType oneDivNyquistRate{};
+    };
+
+    /**
+     * @brief Clear the state of every voice filter
+    */
+    void resetFilters();
+    //================================================================================
+
+    /**
+     * @brief Modulation of every voice,[segment * kMaxVoices + voice] holds the value at the
+     *        end of segment,the kFilterInterval segments of the range from its begin on
+    */
+    struct VoiceModulationBlock {
+        const FType* pitchRatio = nullptr; // multiplies the pitch ratio of the note
+        const FType* level = nullptr;      // multiplies the velocity
+        const FType* cutoff = nullptr;     // replaces FilterBlock::cutoff,only read with a filter
+        const FType* resonance = nullptr;  // replaces FilterBlock::resonance
+    };
+
+    static constexpr int kNoVoice = -1;
+
+    enum class StealPolicy {
+        kOldest,
+        kQuietest
+    };
+
+    VoiceBank();
+
+    /**
+     * @brief Change how many voices can play at the same time,
+     *        voices above the new limit are stopped
+    */
+    void setNumVoices(size_t numVoices);
+    size_t getNumVoices() const { return m_numVoices; }
+
+    void setStealPolicy(StealPolicy policy) { m_stealPolicy = policy; }
+
+    /**
+     * @brief Start a note on a free voice,steal one when all voices are playing.
+     *        A note that is already playing is retriggered on its own voice.
+     * @return The voice,kNoVoice for an invalid note
+    */
+    int noteOn(int noteNumber, float velocity);
+
+    /**
+     * @param shouldRelease Keep the voice playing until finishRelease,
+     *                      the note can start on another voice meanwhile
+     * @return The voice playing the note,kNoVoice when none
+    */
+    int noteOff(int noteNumber, bool shouldRelease = false);
+    void finishRelease(size_t voice);
+
+    bool isPlaying(size_t voice) const { return m_noteNumber[voice] >= 0; }
+    bool isReleasing(size_t voice) const { return m_isReleasing[voice]; }
+    bool hasActiveVoices() const { return m_numActiveVoices != 0; }
+    bool hasReleasingVoices() const { return m_numReleasingVoices != 0; }
+
+    bool isGroupActive(size_t group) const { return m_numActiveInGroup[group] != 0; }
+
+    /**
+     * @brief Add voices of one SIMD group into output buffers.
+     *        Groups touch disjoint state,so different groups may render on different threads.
+    */
+    void addGroupToBlock(size_t group, FType* left, FType* right, const FType* baseIncrement,
+                         size_t beginSamplePos, size_t endSamplePos, const FilterBlock* filter = nullptr,
+                         const VoiceModulationBlock* modulation = nullptr);
+
+    /**
+     * @brief Add all playing voices into output buffers
+     * @param baseIncrement Phase increment of midi note 69 at every sample,
+     *                      a voice's increment is this multiplied by its pitch ratio
+    */
+    void addToBlock(FType* left, FType* right, const FType* baseIncrement,
+                    size_t beginSamplePos, size_t endSamplePos, const FilterBlock* filter = nullptr,
+                    const VoiceModulationBlock* modulation = nullptr);
+private:
+    void startVoice(size_t voice, int noteNumber, float velocity);
+    void stopVoice(size_t voice);
+    void removeFromAgeList(size_t voice);
+    void appendToAgeList(size_t voice);
+    size_t findQuietestVoice() const;
+
+    // coefficients of the voices in group at sample pos,the end of segment
+    void calcFilterCoefficients(size_t group, const FilterBlock& filter, size_t pos,
+                                const VoiceModulationBlock* modulation, size_t segment,
+                                FloatLane& ctof, FloatLane& feedback) const;
+
+    // pitch ratio and gain of the voices in group at the end of segment
+    void calcModulatedVoices(size_t group, const VoiceModulationBlock& modulation, size_t segment,
+                             FType* ratio, FType* gain) const;
+
+    // SoA voice state,one element per voice
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kMaxVoices> m_phase{};
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kMaxVoices> m_pitchRatio{};
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kMaxVoices> m_gain{};
+
+    // voice filters,every group's state in one LaneFilter,coefficients of the last sample per voice
+    std::array<filters::LaneFilter, kNumGroups> m_filters;
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kMaxVoices> m_filterCtof{};
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kMaxVoices> m_filterFeedback{};
+    // a new note's filter starts without ramping from the last note's coefficients
+    std::array<bool, kMaxVoices> m_isFilterCoefficientValid{};
+
+    // modulated pitch ratio and gain at the end of the last range,the same for a new note
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kMaxVoices> m_modulatedRatio{};
+    alignas(Lane::SIMDRegisterSize) std::array<FType, kMaxVoices> m_modulatedGain{};
+    std::array<bool, kMaxVoices> m_isModulationValid{};
+
+    // shared by all instances
+    juce::SharedResourcePointer<SharedWaveTables> m_waveTables;
+
+    // note state,only touched on midi events
+    std::array<int, kMaxVoices> m_noteNumber;
+    std::array<size_t, kNumGroups> m_numActiveInGroup{};
+    size_t m_numActiveVoices = 0;
+    // released notes still playing,they are not in m_voiceOfNote
+    std::array<bool, kMaxVoices> m_isReleasing{};
+    size_t m_numReleasingVoices = 0;
+    size_t m_numVoices = kMaxVoices;
+    StealPolicy m_stealPolicy = StealPolicy::kOldest;
+
+    // allocator,every operation here is O(1) except quietest stealing
+    std::array<int, kNumMidiNotes> m_voiceOfNote;
+    std::array<size_t, kMaxVoices> m_freeVoices{};
+    size_t m_numFreeVoices = 0;
+
+    // playing voices linked from oldest to newest
+    std::array<int, kMaxVoices> m_olderVoice;
+    std::array<int, kMaxVoices> m_newerVoice;
+    int m_oldestVoice = kNoVoice;
+    int m_newestVoice = kNoVoice;
+};
+}
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    WaveTable.cpp
+    Created: 17 Oct 2026 4:35:10pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#include "WaveTable.h"
+
+namespace rpSynth::audio {
+/**
+ * @brief Fill every level from its spectrum with one inverse FFT per level
+ * @param amplitudeOfHarmonic Sine amplitude of the n-th harmonic
+*/
+template<typename Func>
+static void buildMipMaps(MipMappedWaveTable& table, Func amplitudeOfHarmonic) {
+    constexpr size_t kSize = WaveTable::kSize;
+    juce::dsp::FFT fft{static_cast<int>(std::log2(kSize))};
+    std::vector<FType> data(kSize * 2);
+
+    for (size_t level = 0; level < MipMappedWaveTable::kNumLevels; level++) {
+        std::ranges::fill(data, FType{});
+        const auto numHarmonics = MipMappedWaveTable::getNumHarmonics(level);
+        for (size_t h = 1; h <= numHarmonics; h++) {
+            data[2 * h + 1] = amplitudeOfHarmonic(h);
+        }
+        fft.performRealOnlyInverseTransform(data.data());
+
+        // fft scaling and sign differ between fft engines,so match the fundamental instead
+        double fundamental = 0.0;
+        for (size_t i = 0; i < kSize; i++) {
+            fundamental += data[i] * std::sin(juce::MathConstants<double>::twoPi * static_cast<double>(i) / kSize);
+        }
+        fundamental *= 2.0 / kSize;
+        const auto scale = static_cast<FType>(amplitudeOfHarmonic(1) / fundamental);
+
+        auto& samples = table.levels[level].samples;
+        for (size_t i = 0; i < kSize; i++) {
+            samples[i] = data[i] * scale;
+        }
+        samples[kSize] = samples[0];
+    }
+}
+
+SharedWaveTables::SharedWaveTables() {
+    // saw rising from -1 to 1: -2/pi * sum(sin(2pi*h*x)/h)
+    buildMipMaps(m_saw, [](size_t harmonic) {
+        return static_cast<FType>(-2.0 / (juce::MathConstants<double>::pi * static_cast<double>(harmonic)));
+    });
+}
+}
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    WaveTable.h
+    Created: 17 Oct 2026 4:35:10pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <array>
+#include <JuceHeader.h>
+
+#include "../../concepts.h"
+
+namespace rpSynth::audio {
+/**
+ * @brief One cycle of a wave,read with linear interpolation.
+ *        Has a guard point so reading never wraps.
+*/
+struct WaveTable {
+    static constexpr size_t kSize = 2048;
+
+    std::array<FType, kSize + 1> samples{};
+
+    /**
+     * @param phase In [0,1)
+    */
+    FType read(FType phase) const noexcept {
+        const FType position = phase * static_cast<FType>(kSize);
+        // phase just below 1 may round up to kSize
+        const auto index = juce::jmin(static_cast<size_t>(position), kSize - 1);
+        const FType frac = position - static_cast<FType>(index);
+        return samples[index] + frac * (samples[index + 1] - samples[index]);
+    }
+};
+
+/**
+ * @brief Band-limited versions of one wave,one level per octave.
+ *        Level 0 holds every harmonic the table can store,each next level half of them.
+*/
+struct MipMappedWaveTable {
+    static constexpr size_t kNumLevels = 11;
+
+    std::array<WaveTable, kNumLevels> levels;
+
+    static size_t getNumHarmonics(size_t level) {
+        return juce::jmin(WaveTable::kSize / 2 - 1, (WaveTable::kSize / 2) >> level);
+    }
+
+    /**
+     * @brief Two neighbouring levels and the crossfade between them,
+     *        chosen so no harmonic of either level goes above nyquist
+    */
+    struct LevelMix {
+        const WaveTable* lower;
+        const WaveTable* upper;
+        FType fraction;
+    };
+
+    /**
+     * @param phaseIncrement Highest phase increment the table is read with,in (0,0.5]
+    */
+    LevelMix getLevelMix(FType phaseIncrement) const noexcept {
+        // level k is alias free while phaseIncrement <= 2^k / kSize,take the first such level and the next
+        const FType level = std::log2(phaseIncrement * static_cast<FType>(WaveTable::kSize)) + static_cast<FType>(1);
+        if (!(level > FType{})) {
+            return {&levels.front(), &levels.front(), FType{}};
+        }
+        if (level >= static_cast<FType>(kNumLevels - 1)) {
+            return {&levels.back(), &levels.back(), FType{}};
+        }
+
+        const auto index = static_cast<size_t>(level);
+        return {&levels[index], &levels[index + 1], level - static_cast<FType>(index)};
+    }
+};
+
+/**
+ * @brief Read-only tables shared by every voice of every plugin instance in the process.
+ *        Built once by the first user,use it through juce::SharedResourcePointer.
+*/
+class SharedWaveTables {
+public:
+    SharedWaveTables();
+
+    const MipMappedWaveTable& getSaw() const { return m_saw; }
+private:
+    MipMappedWaveTable m_saw;
+};
+}
@@ -15,6 +15,7 @@
 #include <JuceHeader.h>
 #include "../concepts.h"
 #include "modulation/ModulationSetting.h"
+#include "utils/RangeKernels.h"
 
 namespace rpSynth {
 namespace ui {
@@ -23,7 +24,30 @@ class ModulableUIBase;
 
 namespace audio {
 class ModulatorBase;
+class ModulationMatrix;
 class MyHostedAudioProcessorParameter;
+class MyAudioProcessParameter;
+
+/**
+ * @brief Records every MyAudioProcessParameter prepared on this thread while it is alive,
+ *        so a caller can find all parameters of a processor without asking it
+*/
+class ScopedParameterCollector {
+public:
+    explicit ScopedParameterCollector(std::vector<MyAudioProcessParameter*>& parameters)
+        : m_previous(s_current) {
+        s_current = &parameters;
+    }
+
+    ~ScopedParameterCollector() { s_current = m_previous; }
+
+    static void parameterPrepared(MyAudioProcessParameter* p) {
+        if (s_current != nullptr) s_current->push_back(p);
+    }
+private:
+    inline static thread_local std::vector<MyAudioProcessParameter*>* s_current = nullptr;
+    std::vector<MyAudioProcessParameter*>* m_previous;
+};
 
 /**
  * @brief Use this class in audio stream processor,and when init you should
@@ -42,16 +66,20 @@ public:
         : m_canBeModulated(canBeModulated) {
     }
 
-    void prepare(FType sampleRate, size_t numSamples) {
-        m_smoothedValue.reset(sampleRate, kSmoothTimeInSeconds);
-        m_output.resize(numSamples, FType{});
-    }
+    inline void prepare(FType sampleRate, size_t numSamples);
 
-    void updateParameter(size_t numSamples) {
-        for (size_t i = 0; i < numSamples; i++) {
-            m_output[i] = m_smoothedValue.getNextValue();
-        }
-    }
+    inline void updateParameter(size_t numSamples);
+
+    /**
+     * @brief Every sample of this block holds the same value,so get(begin) may
+     *        stand for the whole block.False while smoothing or modulated.
+    */
+    bool isConstant() const { return getReadState().isConstant; }
+
+    /**
+     * @brief A modulator added into this block
+    */
+    bool isModulated() const { return getReadState().isModulated; }
 
     //=========================================================================
     // get
@@ -69,14 +97,32 @@ public:
      * @return ¹éÒ»»¯ºóµÄÖµ,·¶Î§ÔÚ[0,1]
     */
     FType getNormalized(size_t index) const {
-        return juce::jlimit<FType>(0, 1, m_output[index]);
+        return juce::jlimit<FType>(0, 1, getReadBuffer()[index]);
     }
 
     inline FType getNormalizedWithNoScrew() const;
 
     FType getRaw(size_t index) const {
-        return m_output[index];
+        return getReadBuffer()[index];
     }
+
+    /**
+     * @brief Same as get(i) for every i in [begin,end),converted with block kernels
+     * @param dst Scratch of the block size,only [begin,end) is written
+     * @return Read sample i at [i].Either dst,or a cached buffer when the block is constant.
+    */
+    inline const FType* getBlock(size_t begin, size_t end, FType* dst);
+
+    /**
+     * @brief Like getBlock,then from semitone to hertz
+    */
+    inline const FType* getHertzBlock(size_t begin, size_t end, FType* dst);
+
+    /**
+     * @brief Value at index with offsets[k] added in the normalized domain,for every k
+     *        in [0,num).For modulation of one parameter per voice.
+    */
+    inline void getWithOffsets(size_t index, const FType* offsets, FType* dst, size_t num) const;
     //=========================================================================
 
     //=========================================================================
@@ -91,23 +137,6 @@ public:
     }
     //=========================================================================
 
-    //================================================================================
-    // Processing
-
-    /**
-     * @brief ¶Ô»º³åÇøÄÚµÄËùÓÐÊý×Ö´Ó°ëÒô×ª»»µ½ÆµÂÊ,
-     *        Çë×¢ÒâÕâ¸ö²Ù×÷ÎÞ·¨³·»Ø,Ö®ºóÄãÓ¦¸ÃÊ¹ÓÃgetRaw·½·¨»ñÈ¡²ÎÊý
-    */
-    inline void applySemitoneToHertz();
-
-    /**
-     * @brief ¶ÔÖ¸¶¨·¶Î§ÄÚ[begin,end)µÄËùÓÐÊý×Ö´Ó°ëÒô×ª»»µ½ÆµÂÊ,Ò²ÊÇÎÞ·¨³·»Ø,Ö®ºóÄãÓ¦¸ÃÊ¹ÓÃgetRaw·½·¨»ñÈ¡²ÎÊý
-     * @param begin ¿ªÊ¼
-     * @param end ½áÊø
-    */
-    inline void applySemitoneToHertz(size_t begin, size_t end);
-    //================================================================================
-
     //================================================================================
     // Modulations
     void modulatorAdded(ModulationSettings* pM) {
@@ -143,16 +172,113 @@ public:
     //================================================================================
     
 
+    //================================================================================
+    // Pipelining
+
+    /**
+     * @brief A pipelined parameter is read from the blocks handed over by swapPipelineBuffers,
+     *        so its processor can run later or on another thread while the next blocks are written
+    */
+    void setPipelined(bool shouldBePipelined) { m_isPipelined = shouldBePipelined; }
+
+    /**
+     * @brief Room for numSlots blocks on each side,call it after prepare
+    */
+    void preparePipelineSlots(size_t numSlots) {
+        m_pipelineWriteSlots.resize(numSlots);
+        m_pipelineReadSlots.resize(numSlots);
+        m_pipelineWriteStates.assign(numSlots, BlockState{});
+        m_pipelineReadStates.assign(numSlots, BlockState{});
+        for (size_t i = 0; i < numSlots; i++) {
+            m_pipelineWriteSlots[i].resize(m_output.size(), FType{});
+            m_pipelineReadSlots[i].resize(m_output.size(), FType{});
+        }
+        m_pipelineReadSlot = 0;
+    }
+
+    /**
+     * @brief Keep the block just written (smoothed and modulated) in slot
+    */
+    void storePipelineBlock(size_t slot) {
+        std::swap(m_output, m_pipelineWriteSlots[slot]);
+        std::swap(m_outputState, m_pipelineWriteStates[slot]);
+    }
+
+    /**
+     * @brief Hand every stored block over to the reader
+    */
+    void swapPipelineBuffers() {
+        std::swap(m_pipelineWriteSlots, m_pipelineReadSlots);
+        std::swap(m_pipelineWriteStates, m_pipelineReadStates);
+    }
+
+    /**
+     * @brief Block the reader sees,reader side only
+    */
+    void setPipelineReadSlot(size_t slot) { m_pipelineReadSlot = slot; }
+    //================================================================================
+
     // Must have a hosted parameter if using this class
     MyHostedAudioProcessorParameter* getHostParameter() const { jassert(m_juceAudioParameter != nullptr); return m_juceAudioParameter; }
     inline juce::String getParameterID() const;
 private:
     friend class ModulatorBase;
+    friend class ModulationMatrix;
     friend class MyHostedAudioProcessorParameter;
 
+    struct BlockState {
+        bool isConstant = false;
+        bool isModulated = false;
+        // buffer is filled with value,in the normalized domain
+        bool isClean = false;
+        FType value{};
+        // value in the range of the hosted parameter
+        FType convertedValue{};
+    };
+
+    const SampleBuffer& getReadBuffer() const { return m_isPipelined ? m_pipelineReadSlots[m_pipelineReadSlot] : m_output; }
+    SampleBuffer& getReadBuffer() { return m_isPipelined ? m_pipelineReadSlots[m_pipelineReadSlot] : m_output; }
+    const BlockState& getReadState() const { return m_isPipelined ? m_pipelineReadStates[m_pipelineReadSlot] : m_outputState; }
+    BlockState& getReadState() { return m_isPipelined ? m_pipelineReadStates[m_pipelineReadSlot] : m_outputState; }
+
+    /**
+     * @brief Buffer of the block being written,for ModulationMatrix to add into
+    */
+    SampleBuffer& getBufferForModulation() {
+        m_outputState.isConstant = false;
+        m_outputState.isModulated = true;
+        m_outputState.isClean = false;
+        return m_output;
+    }
+
+    /**
+     * @brief A buffer filled with value,filled again only when value changes
+    */
+    const FType* getConstantBlock(FType value) {
+        if (!m_isConstantBlockValid || m_constantBlockValue != value) {
+            std::fill(m_constantBlock.begin(), m_constantBlock.end(), value);
+            m_constantBlockValue = value;
+            m_isConstantBlockValid = true;
+        }
+        return m_constantBlock.data();
+    }
+
     bool m_canBeModulated;
     juce::SmoothedValue<FType> m_smoothedValue;
-    std::vector<FType> m_output;
+    SampleBuffer m_output;
+    BlockState m_outputState;
+    // one block per micro block of a span,written and read side
+    std::vector<SampleBuffer> m_pipelineWriteSlots;
+    std::vector<SampleBuffer> m_pipelineReadSlots;
+    std::vector<BlockState> m_pipelineWriteStates;
+    std::vector<BlockState> m_pipelineReadStates;
+    size_t m_pipelineReadSlot = 0;
+    bool m_isPipelined = false;
+    kernels::RangeConverter m_converter;
+    // read side only
+    SampleBuffer m_constantBlock;
+    FType m_constantBlockValue{};
+    bool m_isConstantBlockValid = false;
     std::vector<ModulationSettings*> m_modulationSettings;
     MyHostedAudioProcessorParameter* m_juceAudioParameter = nullptr;
 };
@@ -189,26 +315,78 @@ private:
     MyAudioProcessParameter* m_audioProcessorParameter;
 };
 
-inline FType MyAudioProcessParameter::get(size_t index) const {
-    return m_juceAudioParameter->convertFrom0to1(m_output[index]);
+inline void MyAudioProcessParameter::prepare(FType sampleRate, size_t numSamples) {
+    m_smoothedValue.reset(sampleRate, kSmoothTimeInSeconds);
+    m_output.resize(numSamples, FType{});
+    m_outputState = BlockState{};
+    m_pipelineWriteSlots.clear();
+    m_pipelineReadSlots.clear();
+    m_pipelineWriteStates.clear();
+    m_pipelineReadStates.clear();
+    m_pipelineReadSlot = 0;
+    m_constantBlock.resize(numSamples, FType{});
+    m_isConstantBlockValid = false;
+    if (m_juceAudioParameter != nullptr) {
+        m_converter = kernels::RangeConverter{m_juceAudioParameter->range};
+    }
+    ScopedParameterCollector::parameterPrepared(this);
 }
 
-inline FType MyAudioProcessParameter::getNormalizedWithNoScrew() const {
-    auto& range = m_juceAudioParameter->range;
-    auto cur = m_smoothedValue.getCurrentValue();
-    return juce::jlimit<FType>(0, 1, (cur - range.start) / (range.end - range.start));
+inline void MyAudioProcessParameter::updateParameter(size_t numSamples) {
+    if (m_smoothedValue.isSmoothing()) {
+        for (size_t i = 0; i < numSamples; i++) {
+            m_output[i] = m_smoothedValue.getNextValue();
+        }
+        m_outputState = BlockState{};
+        return;
+    }
+
+    // settled,the buffer only needs a fill when it holds something else
+    const FType value = m_smoothedValue.getCurrentValue();
+    if (!m_outputState.isClean || m_outputState.value != value) {
+        std::fill(m_output.begin(), m_output.end(), value);
+        m_outputState.convertedValue = m_juceAudioParameter != nullptr
+            ? m_juceAudioParameter->convertFrom0to1(value) : value;
+    }
+    m_outputState.isConstant = true;
+    m_outputState.isModulated = false;
+    m_outputState.isClean = true;
+    m_outputState.value = value;
 }
 
-inline void MyAudioProcessParameter::applySemitoneToHertz() {
-    for (auto& v : m_output) {
-        v = semitoneToHertz(m_juceAudioParameter->convertFrom0to1(v));
+inline FType MyAudioProcessParameter::get(size_t index) const {
+    if (const auto& state = getReadState(); state.isConstant) {
+        return state.convertedValue;
     }
+    return m_juceAudioParameter->convertFrom0to1(getReadBuffer()[index]);
 }
 
-inline void MyAudioProcessParameter::applySemitoneToHertz(size_t begin, size_t end) {
-    for (; begin < end; begin++) {
-        m_output[begin] = semitoneToHertz(m_juceAudioParameter->convertFrom0to1(m_output[begin]));
+inline const FType* MyAudioProcessParameter::getBlock(size_t begin, size_t end, FType* dst) {
+    if (const auto& state = getReadState(); state.isConstant) {
+        return getConstantBlock(state.convertedValue);
     }
+    m_converter.convertFrom0to1(getReadBuffer().data() + begin, dst + begin, end - begin);
+    return dst;
+}
+
+inline const FType* MyAudioProcessParameter::getHertzBlock(size_t begin, size_t end, FType* dst) {
+    if (const auto& state = getReadState(); state.isConstant) {
+        return getConstantBlock(kernels::semitoneToHertz(state.convertedValue));
+    }
+    m_converter.convertFrom0to1(getReadBuffer().data() + begin, dst + begin, end - begin);
+    kernels::semitoneToHertz(dst + begin, dst + begin, end - begin);
+    return dst;
+}
+
+inline void MyAudioProcessParameter::getWithOffsets(size_t index, const FType* offsets, FType* dst, size_t num) const {
+    juce::FloatVectorOperations::add(dst, offsets, getReadBuffer()[index], static_cast<int>(num));
+    m_converter.convertFrom0to1(dst, dst, num);
+}
+
+inline FType MyAudioProcessParameter::getNormalizedWithNoScrew() const {
+    auto& range = m_juceAudioParameter->range;
+    auto cur = m_smoothedValue.getCurrentValue();
+    return juce::jlimit<FType>(0, 1, (cur - range.start) / (range.end - range.start));
 }
 
 inline juce::String rpSynth::audio::MyAudioProcessParameter::getParameterID() const {
@@ -9,7 +9,9 @@
 */
 
 #include "Envelop.h"
+#if ! RPSYNTH_HEADLESS
 #include "ui/modulation/EnvelopPanel.h"
+#endif
 
 namespace rpSynth::audio {
 static constexpr FType oneThousandInv = static_cast<FType>(0.001);
@@ -49,6 +51,14 @@ void Envelop::updateParameters(size_t numSamples) {
     m_decayInMillSeconds.updateParameter(numSamples);
     m_sustainLevelInDecibels.updateParameter(numSamples);
     m_releaseInMillSeconds.updateParameter(numSamples);
+
+    // a note on in this block starts its stages with the lengths of the block,
+    // no matter whether any voice was advanced since the knobs moved
+    setVoiceStageLengths(m_attackInMillSeconds.get(0),
+                         m_holdInMillSeconds.get(0),
+                         m_decayInMillSeconds.get(0),
+                         m_sustainLevelInDecibels.get(0),
+                         m_releaseInMillSeconds.get(0));
 }
 
 void Envelop::prepareParameters(FType sampleRate, size_t numSamples) {
@@ -62,6 +72,17 @@ void Envelop::prepareParameters(FType sampleRate, size_t numSamples) {
 void Envelop::prepareExtra(FType sr, size_t /*num*/) {
     m_linearSmoother.reset(sr, kCRSmoothTime);
     m_totalNumSamples = static_cast<size_t>(sr / kControlRate);
+
+    // parameter buffers are not filled before the first block,the hosted values are current
+    setVoiceStageLengths(m_attackInMillSeconds.getHostParameter()->get(),
+                         m_holdInMillSeconds.getHostParameter()->get(),
+                         m_decayInMillSeconds.getHostParameter()->get(),
+                         m_sustainLevelInDecibels.getHostParameter()->get(),
+                         m_releaseInMillSeconds.getHostParameter()->get());
+    m_voiceState.fill(EnvelopState::Init);
+    m_voiceOutput.fill(FType{});
+    m_voiceSlope.fill(FType{});
+    m_voiceRemaining.fill(kEndless);
 }
 
 void Envelop::saveExtraState(juce::XmlElement& /*xml*/) {
@@ -166,9 +187,124 @@ void Envelop::noteOff() {
     }
 }
 
+//===============================================================
+void Envelop::voiceOn(size_t voice) {
+    // from where the voice is now,so a stolen voice does not click
+    startVoiceStage(voice, EnvelopState::Attack);
+}
+
+void Envelop::voiceOff(size_t voice) {
+    if (m_voiceState[voice] != EnvelopState::Init) {
+        startVoiceStage(voice, EnvelopState::Release);
+    }
+}
+
+void Envelop::setVoiceStageLengths(FType attack, FType hold, FType decay, FType sustainLevel, FType release) {
+    const FType samplesPerMillSecond = m_sampleRate * oneThousandInv;
+    m_voiceAttack = samplesPerMillSecond * attack;
+    m_voiceHold = samplesPerMillSecond * hold;
+    m_voiceDecay = samplesPerMillSecond * decay;
+    m_voiceSustain = sustainLevel;
+    m_voiceRelease = samplesPerMillSecond * release;
+}
+
+void Envelop::startVoiceStage(size_t voice, EnvelopState state) {
+    auto& value = m_voiceOutput[voice];
+    auto& slope = m_voiceSlope[voice];
+    auto& remaining = m_voiceRemaining[voice];
+    m_voiceState[voice] = state;
+    switch (state) {
+        case EnvelopState::Attack:
+            slope = m_voiceAttack > FType{} ? static_cast<FType>(1) / m_voiceAttack : FType{};
+            remaining = m_voiceAttack * (static_cast<FType>(1) - value);
+            break;
+        case EnvelopState::Hold:
+            value = static_cast<FType>(1);
+            slope = FType{};
+            remaining = m_voiceHold;
+            break;
+        case EnvelopState::Decay:
+            value = static_cast<FType>(1);
+            slope = m_voiceDecay > FType{} ? (m_voiceSustain - value) / m_voiceDecay : FType{};
+            remaining = m_voiceDecay;
+            break;
+        case EnvelopState::Sustain:
+            value = m_voiceSustain;
+            slope = FType{};
+            remaining = kEndless;
+            break;
+        case EnvelopState::Release:
+            // from the current level,a note released in attack does not jump to sustain first
+            slope = m_voiceRelease > FType{} ? -value / m_voiceRelease : FType{};
+            remaining = m_voiceRelease;
+            break;
+        case EnvelopState::Init:
+        default:
+            value = FType{};
+            slope = FType{};
+            remaining = kEndless;
+            break;
+    }
+}
+
+void Envelop::finishVoiceStage(size_t voice) {
+    // zero length stages are passed in one call
+    while (m_voiceRemaining[voice] <= FType{}) {
+        const FType pastEnd = -m_voiceRemaining[voice];
+        switch (m_voiceState[voice]) {
+            case EnvelopState::Attack:
+                startVoiceStage(voice, EnvelopState::Hold);
+                break;
+            case EnvelopState::Hold:
+                startVoiceStage(voice, EnvelopState::Decay);
+                break;
+            case EnvelopState::Decay:
+                startVoiceStage(voice, EnvelopState::Sustain);
+                break;
+            case EnvelopState::Release:
+                startVoiceStage(voice, EnvelopState::Init);
+                break;
+            default:
+                m_voiceRemaining[voice] = kEndless;
+                return;
+        }
+        m_voiceOutput[voice] += m_voiceSlope[voice] * juce::jmin(pastEnd, m_voiceRemaining[voice]);
+        m_voiceRemaining[voice] -= pastEnd;
+    }
+}
+
+void Envelop::generateVoiceData(const size_t* groups, size_t numGroups, size_t index, size_t numSamples) {
+    setVoiceStageLengths(m_attackInMillSeconds.get(index),
+                         m_holdInMillSeconds.get(index),
+                         m_decayInMillSeconds.get(index),
+                         m_sustainLevelInDecibels.get(index),
+                         m_releaseInMillSeconds.get(index));
+
+    const auto n = FloatLane::expand(static_cast<FType>(numSamples));
+    for (size_t i = 0; i < numGroups; i++) {
+        const size_t first = groups[i] * kModulatorVoiceGroupSize;
+        const auto remaining = FloatLane::load(m_voiceRemaining.data() + first);
+        // a line never passes its end,the rest is done by finishVoiceStage
+        (FloatLane::load(m_voiceOutput.data() + first)
+         + FloatLane::load(m_voiceSlope.data() + first) * FloatLane::min(n, remaining)).store(m_voiceOutput.data() + first);
+        (remaining - n).store(m_voiceRemaining.data() + first);
+
+        for (size_t voice = first; voice < first + kModulatorVoiceGroupSize; voice++) {
+            if (m_voiceState[voice] == EnvelopState::Sustain) {
+                m_voiceOutput[voice] = m_voiceSustain;
+            } else if (m_voiceRemaining[voice] <= FType{}) {
+                finishVoiceStage(voice);
+            }
+        }
+    }
+}
+//===============================================================
+
+#if ! RPSYNTH_HEADLESS
 JUCE_NODISCARD juce::Component* Envelop::createControlComponent() {
     return new ui::EnvelopPanel(*this);
 }
+#endif
 
 //===============================================================
 std::pair<Envelop::EnvelopState, float> Envelop::getCurrentEnvelopState() const {
@@ -49,7 +49,14 @@ public:
     FType onCRClock(size_t intervalSamplesInSR, size_t index);
     void noteOn() override;
     void noteOff() override;
+    bool isPolyphonic() const override { return true; }
+    void voiceOn(size_t voice) override;
+    void voiceOff(size_t voice) override;
+    bool isVoiceActive(size_t voice) const override { return m_voiceState[voice] != EnvelopState::Init; }
+    void generateVoiceData(const size_t* groups, size_t numGroups, size_t index, size_t numSamples) override;
+#if ! RPSYNTH_HEADLESS
     JUCE_NODISCARD juce::Component* createControlComponent() override;
+#endif
     //===============================================================
 
     //===============================================================
@@ -69,6 +76,28 @@ private:
     size_t m_holdLength = 0;
     size_t m_decayLength = 0;
     size_t m_releaseLength = 0;
+
+    //===============================================================
+    // voices,every stage is a line: m_voiceOutput moves by slope per sample
+    // until remaining samples run out,so all voices advance together in FloatLane
+    static constexpr FType kEndless = static_cast<FType>(1e30);
+
+    // in milliseconds,stored in samples
+    void setVoiceStageLengths(FType attack, FType hold, FType decay, FType sustainLevel, FType release);
+    void startVoiceStage(size_t voice, EnvelopState state);
+    // remaining ran out,move to the next stages with the samples past the end
+    void finishVoiceStage(size_t voice);
+
+    alignas(16) std::array<FType, kMaxModulatorVoices> m_voiceSlope{};
+    alignas(16) std::array<FType, kMaxModulatorVoices> m_voiceRemaining{};
+    std::array<EnvelopState, kMaxModulatorVoices> m_voiceState{};
+    // stage lengths in samples,read from parameters every block and by generateVoiceData
+    FType m_voiceAttack{};
+    FType m_voiceHold{};
+    FType m_voiceDecay{};
+    FType m_voiceSustain{};
+    FType m_voiceRelease{};
+    //===============================================================
 public:
     // Parameters
     MyAudioProcessParameter m_attackInMillSeconds{false};
@@ -15,7 +15,9 @@
 #include "ModulatorBase.h"
 #include "LineGenerator.h"
 #include "synthesizer/AudioProcessorBase.h"
+#if ! RPSYNTH_HEADLESS
 #include "ui/modulation/LFOPanel.h"
+#endif
 
 namespace rpSynth::audio {
 class LFO : public ModulatorBase {
@@ -82,6 +84,7 @@ public:
     void prepareExtra(FType sr, size_t /*num*/) override {
         m_linearSmoother.reset(sr, kCRSmoothTime);
         m_totalNumSamples = static_cast<size_t>(sr / kControlRate);
+        m_voicePhase.fill(FType{});
     }
 
     void generateData(size_t beginSamplePos, size_t endSamplePos) override {
@@ -136,9 +139,45 @@ public:
 
     }
 
+    //===============================================================
+    // voices,every voice has its own phase from its note on
+    bool isPolyphonic() const override { return true; }
+
+    void voiceOn(size_t voice) override {
+        m_voicePhase[voice] = FType{};
+        m_voiceOutput[voice] = m_lookUpTable[0];
+    }
+
+    void generateVoiceData(const size_t* groups, size_t numGroups, size_t index, size_t numSamples) override {
+        using Lane = juce::dsp::SIMDRegister<FType>;
+        static_assert(Lane::SIMDNumElements == kModulatorVoiceGroupSize, "a voice group is one SIMD register");
+
+        // below 1,so phase only wraps once
+        const FType advance = std::fmod(m_lfoFrequency.get(index) * static_cast<FType>(numSamples) / m_sampleRate,
+                                        static_cast<FType>(1));
+        const auto one = Lane::expand(static_cast<FType>(1));
+        for (size_t i = 0; i < numGroups; i++) {
+            const size_t first = groups[i] * kModulatorVoiceGroupSize;
+            auto phase = Lane::fromRawArray(m_voicePhase.data() + first) + Lane::expand(advance);
+            phase -= one & Lane::greaterThanOrEqual(phase, one);
+            phase.copyToRawArray(m_voicePhase.data() + first);
+
+            // table reads are per voice
+            for (size_t voice = first; voice < first + kModulatorVoiceGroupSize; voice++) {
+                const FType position = m_voicePhase[voice] * static_cast<FType>(kResolution);
+                const auto lower = juce::jmin(static_cast<size_t>(position), kResolution - 1);
+                const FType fraction = position - static_cast<FType>(lower);
+                m_voiceOutput[voice] = m_lookUpTable[lower] + fraction * (m_lookUpTable[lower + 1] - m_lookUpTable[lower]);
+            }
+        }
+    }
+    //===============================================================
+
+#if ! RPSYNTH_HEADLESS
     JUCE_NODISCARD juce::Component* createControlComponent() override {
         return new ui::LFOPanel(*this);
     }
+#endif
 
     void saveExtraState(juce::XmlElement& xml) override {
         m_lineGenerator.saveState(xml);
@@ -162,6 +201,8 @@ private:
 
     std::array<FType, kResolution + 1> m_lookUpTable;
     Phase m_phase;
+
+    alignas(16) std::array<FType, kMaxModulatorVoices> m_voicePhase{};
 };
 }
 #endif // !RPSYNTH_MODULATION_LFO_H
@@ -84,6 +84,15 @@ public:
     }
 
     decltype(auto) getAllModulators() { return (m_modulators); }
+
+    /**
+     * @brief Let matrix apply the links of every modulator added so far
+    */
+    void connectTo(ModulationMatrix& matrix) {
+        for (auto& m : m_modulators) {
+            matrix.addModulator(*m);
+        }
+    }
     //=========================================================================
     // Save Modulator ID, Parameter ID and ModulationSettings to xml
     // Use MyAudioProcessParameter::getParameterID to find parameterID
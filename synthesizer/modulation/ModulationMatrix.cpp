@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.cpp
+    Created: 17 Oct 2026 9:14:02pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <functional>
+#include "ModulationMatrix.h"
+#include "ModulatorBase.h"
+
+namespace rpSynth::audio {
+/**
+ * @brief dst += modulation * amount,amount ramps linearly from startAmount to endAmount
+ * @param bipolar Map modulation from [0,1] to [-1,1] first
+*/
+static void addModulation(FType* dst, const FType* modulation, size_t numSamples,
+                          FType startAmount, FType endAmount, bool bipolar) {
+    const auto num = static_cast<int>(numSamples);
+    if (startAmount == endAmount) {
+        if (bipolar) {
+            // (2m - 1) * a = m * 2a - a
+            juce::FloatVectorOperations::addWithMultiply(dst, modulation, static_cast<FType>(2) * endAmount, num);
+            juce::FloatVectorOperations::add(dst, -endAmount, num);
+        } else {
+            juce::FloatVectorOperations::addWithMultiply(dst, modulation, endAmount, num);
+        }
+        return;
+    }
+
+    // only while an amount is moving,a plain loop the compiler vectorizes
+    const FType step = (endAmount - startAmount) / static_cast<FType>(numSamples);
+    const FType scale = bipolar ? static_cast<FType>(2) : static_cast<FType>(1);
+    const FType offset = bipolar ? static_cast<FType>(-1) : static_cast<FType>(0);
+    for (size_t i = 0; i < numSamples; i++) {
+        const FType amount = startAmount + step * static_cast<FType>(i + 1);
+        dst[i] += (modulation[i] * scale + offset) * amount;
+    }
+}
+
+void ModulationMatrix::addModulator(ModulatorBase& modulator) {
+    modulator.setModulationMatrix(this);
+    m_modulators.push_back(&modulator);
+    rebuild();
+}
+
+void ModulationMatrix::addVoiceTarget(MyAudioProcessParameter& target, size_t index) {
+    m_voiceTargets.emplace_back(&target, index);
+}
+
+void ModulationMatrix::rebuild() {
+    auto table = std::make_unique<RoutingTable>();
+    for (auto* modulator : m_modulators) {
+        for (auto* set : modulator->getAllModulationSettings()) {
+            auto voiceTarget = std::ranges::find(m_voiceTargets, set->target, [](const auto& t) { return t.first; });
+            if (modulator->isPolyphonic() && voiceTarget != m_voiceTargets.end()) {
+                table->voiceRoutes.push_back(VoiceRoute{modulator, voiceTarget->second, set});
+                if (std::ranges::find(table->voiceModulators, modulator) == table->voiceModulators.end()) {
+                    table->voiceModulators.push_back(modulator);
+                }
+                continue;
+            }
+            table->routes.push_back(Route{&modulator->getOutputBuffer(), set->target, set});
+        }
+    }
+
+    // links of one target next to each other,still in modulator order
+    std::ranges::stable_sort(table->routes, std::ranges::less{}, &Route::target);
+    m_table.publish(std::move(table));
+}
+
+void ModulationMatrix::retire(std::unique_ptr<ModulationSettings> removed) {
+    m_table.retire(std::move(removed));
+}
+
+void ModulationMatrix::prepare(FType sampleRate) {
+    m_maxAmountStepPerSample = static_cast<FType>(1) / (kAmountRampTimeInSeconds * sampleRate);
+
+    // links start at their amount instead of ramping up from 0
+    const auto* table = m_table.acquire();
+    if (table == nullptr) return;
+    for (const auto& route : table->routes) {
+        route.settings->snapAmount();
+    }
+    for (const auto& route : table->voiceRoutes) {
+        route.settings->snapAmount();
+    }
+}
+
+void ModulationMatrix::process(size_t beginSamplePos, size_t endSamplePos) {
+    const auto* table = m_table.acquire();
+    if (table == nullptr || beginSamplePos == endSamplePos) return;
+
+    const auto numSamples = endSamplePos - beginSamplePos;
+    const FType maxStep = m_maxAmountStepPerSample * static_cast<FType>(numSamples);
+    MyAudioProcessParameter* target = nullptr;
+    SampleBuffer* buffer = nullptr;
+    for (const auto& route : table->routes) {
+        auto& set = *route.settings;
+        const FType startAmount = set.currentAmount;
+        const FType endAmount = stepAmount(set, maxStep);
+
+        // a bypassed link leaves its target constant
+        if (startAmount == FType{} && endAmount == FType{}) continue;
+
+        if (route.target != target) {
+            target = route.target;
+            buffer = &target->getBufferForModulation();
+        }
+        addModulation(buffer->data() + beginSamplePos, route.source->data() + beginSamplePos, numSamples,
+                      startAmount, endAmount, set.bipolar.load(std::memory_order_relaxed));
+    }
+}
+
+FType ModulationMatrix::stepAmount(ModulationSettings& set, FType maxStep) const {
+    const FType targetAmount = set.bypass.load(std::memory_order_relaxed)
+        ? FType{} : set.amount.load(std::memory_order_relaxed);
+    set.currentAmount += juce::jlimit(-maxStep, maxStep, targetAmount - set.currentAmount);
+    return set.currentAmount;
+}
+
+void ModulationMatrix::voiceOn(size_t voice) {
+    for (auto* modulator : m_modulators) {
+        modulator->voiceOn(voice);
+    }
+}
+
+void ModulationMatrix::voiceOff(size_t voice) {
+    for (auto* modulator : m_modulators) {
+        modulator->voiceOff(voice);
+    }
+}
+
+bool ModulationMatrix::hasVoiceRoutes() {
+    const auto* table = m_table.acquire();
+    return table != nullptr && !table->voiceRoutes.empty();
+}
+
+bool ModulationMatrix::hasVoiceRoutes(size_t targetIndex) {
+    const auto* table = m_table.acquire();
+    if (table == nullptr) return false;
+    return std::ranges::any_of(table->voiceRoutes, [targetIndex](const VoiceRoute& route) {
+        return route.targetIndex == targetIndex;
+    });
+}
+
+bool ModulationMatrix::isVoiceActive(size_t voice, size_t targetIndex) {
+    const auto* table = m_table.acquire();
+    if (table == nullptr) return false;
+    return std::ranges::any_of(table->voiceRoutes, [voice, targetIndex](const VoiceRoute& route) {
+        return route.targetIndex == targetIndex && route.source->isVoiceActive(voice);
+    });
+}
+
+void ModulationMatrix::processVoices(const size_t* groups, size_t numGroups, size_t index, size_t numSamples,
+                                     FType* offsets) {
+    const auto* table = m_table.acquire();
+    if (table == nullptr || table->voiceRoutes.empty() || numSamples == 0) return;
+
+    // every modulator once,however many voice targets it is linked to
+    for (auto* modulator : table->voiceModulators) {
+        modulator->generateVoiceData(groups, numGroups, index, numSamples);
+    }
+
+    // the voice ramps between ranges,so the amount only needs its value at the end
+    const FType maxStep = m_maxAmountStepPerSample * static_cast<FType>(numSamples);
+    for (const auto& route : table->voiceRoutes) {
+        const FType amount = stepAmount(*route.settings, maxStep);
+        if (amount == FType{}) continue;
+
+        const bool bipolar = route.settings->bipolar.load(std::memory_order_relaxed);
+        const auto scale = FloatLane::expand(bipolar ? static_cast<FType>(2) * amount : amount);
+        const auto offset = FloatLane::expand(bipolar ? -amount : FType{});
+        const FType* values = route.source->getVoiceOutput();
+        FType* dst = offsets + route.targetIndex * kMaxModulatorVoices;
+        for (size_t i = 0; i < numGroups; i++) {
+            const size_t voice = groups[i] * kModulatorVoiceGroupSize;
+            (FloatLane::load(dst + voice) + FloatLane::load(values + voice) * scale + offset).store(dst + voice);
+        }
+    }
+}
+}
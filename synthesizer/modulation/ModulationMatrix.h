@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.h
+    Created: 17 Oct 2026 9:14:02pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#ifndef RPSYNTH_MODULATION_MODULATIONMATRIX_H
+#define RPSYNTH_MODULATION_MODULATIONMATRIX_H
+
+#include <utility>
+#include <vector>
+#include "ModulationSetting.h"
+#include "synthesizer/utils/LockFreePublisher.h"
+
+namespace rpSynth::audio {
+class ModulatorBase;
+class MyAudioProcessParameter;
+
+/**
+ * @brief Adds every modulator's output into the parameters it is linked to.
+ *        The links are compiled into a flat table sorted by target on the message
+ *        thread,and handed over to the audio thread without locks.
+*/
+class ModulationMatrix {
+public:
+    // time for an amount to move by 1,so editing a link does not click
+    static constexpr FType kAmountRampTimeInSeconds = static_cast<FType>(0.02);
+
+    //================================================================================
+    // message thread
+
+    /**
+     * @brief Register a modulator,its links are in the table from the next rebuild on
+    */
+    void addModulator(ModulatorBase& modulator);
+
+    /**
+     * @brief Compile the links of every modulator into a new table and publish it
+    */
+    void rebuild();
+
+    /**
+     * @brief Free a removed link once the audio thread can not see it any more.
+     *        Call rebuild after it.
+    */
+    void retire(std::unique_ptr<ModulationSettings> removed);
+
+    /**
+     * @brief A parameter of every voice.Links from polyphonic modulators to it are left out
+     *        of its buffer,processVoices adds them per voice at index instead.
+     *        Takes effect on the next rebuild.
+    */
+    void addVoiceTarget(MyAudioProcessParameter& target, size_t index);
+    //================================================================================
+
+    //================================================================================
+    // audio thread
+    void prepare(FType sampleRate);
+
+    /**
+     * @brief Add modulators' output of [begin,end) into targets,
+     *        call it after every modulator generated this range
+    */
+    void process(size_t beginSamplePos, size_t endSamplePos);
+
+    // voice state of every polyphonic modulator
+    void voiceOn(size_t voice);
+    void voiceOff(size_t voice);
+
+    bool hasVoiceRoutes();
+    bool hasVoiceRoutes(size_t targetIndex);
+
+    /**
+     * @brief A modulator linked to the voice target is still moving for voice
+    */
+    bool isVoiceActive(size_t voice, size_t targetIndex);
+
+    /**
+     * @brief Advance polyphonic modulators linked to voice targets by numSamples,then add
+     *        their links into offsets[targetIndex * kMaxModulatorVoices + voice],in the
+     *        normalized domain of the target.Only voices of groups are touched.
+     * @param index Sample of the block the range ends at
+    */
+    void processVoices(const size_t* groups, size_t numGroups, size_t index, size_t numSamples, FType* offsets);
+    //================================================================================
+private:
+    struct Route {
+        const SampleBuffer* source;
+        MyAudioProcessParameter* target;
+        ModulationSettings* settings;
+    };
+
+    struct VoiceRoute {
+        const ModulatorBase* source;
+        size_t targetIndex;
+        ModulationSettings* settings;
+    };
+
+    struct RoutingTable {
+        std::vector<Route> routes;
+        std::vector<VoiceRoute> voiceRoutes;
+        // sources of voiceRoutes,each once
+        std::vector<ModulatorBase*> voiceModulators;
+    };
+
+    // amount of a link after one more step towards its target
+    FType stepAmount(ModulationSettings& set, FType maxStep) const;
+
+    // only changed while the synthesizer is built
+    std::vector<ModulatorBase*> m_modulators;
+    std::vector<std::pair<const MyAudioProcessParameter*, size_t>> m_voiceTargets;
+    LockFreePublisher<RoutingTable> m_table;
+    FType m_maxAmountStepPerSample{};
+};
+}
+
+#endif // !RPSYNTH_MODULATION_MODULATIONMATRIX_H
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <atomic>
 #include "../../concepts.h"
 
 namespace rpSynth::audio {
@@ -39,10 +40,19 @@ struct ModulationSettings {
         amount = juce::jlimit<FType>(-1, 1, val);
     }
 
-    bool bypass = kBypass;
-    bool bipolar = kBipolar;
-    FType amount = kAmount;
+    // jump currentAmount to its target,only live changes should ramp
+    void snapAmount() {
+        currentAmount = bypass ? FType{} : amount.load();
+    }
+
+    // written by ui,read by audio thread
+    std::atomic<bool> bypass = kBypass;
+    std::atomic<bool> bipolar = kBipolar;
+    std::atomic<FType> amount = kAmount;
     MyAudioProcessParameter* target = nullptr;
     ModulatorBase* modulator = nullptr;
+
+    // amount the audio thread applied last,follows amount(0 when bypassed) smoothly
+    FType currentAmount{};
 };
 }
\ No newline at end of file
@@ -12,10 +12,13 @@
 #ifndef RPSYNTH_MODULATION_IMODULATOR_H
 #define RPSYNTH_MODULATION_IMODULATOR_H
 
+#include <array>
 #include <vector>
 #include "ModulationSetting.h"
+#include "ModulationMatrix.h"
 #include "synthesizer/WrapParameter.h"
 #include "synthesizer/AudioProcessorBase.h"
+#include "synthesizer/utils/SimdLane.h"
 
 namespace rpSynth::audio {
 //================================================================================
@@ -23,6 +26,9 @@ namespace rpSynth::audio {
 //================================================================================
 static constexpr double kCRSmoothTime = 0.05;// 50ms
 static constexpr size_t kControlRate = 400;// 400hz
+// state slots of a polyphonic modulator,one per voice of the oscillor
+static constexpr size_t kMaxModulatorVoices = 64;
+static constexpr size_t kModulatorVoiceGroupSize = FloatLane::kNumElements;
 
 class ModulatorBase : public AudioProcessorBase {
 public:
@@ -34,7 +40,23 @@ public:
     virtual void prepareExtra(FType sampleRate, size_t numSamples) = 0;
     virtual void noteOn() = 0;
     virtual void noteOff() = 0;
+
+    // polyphonic,a modulator keeps one state per voice besides the global one.
+    // Voices are advanced in groups of kModulatorVoiceGroupSize,see ModulationMatrix::processVoices
+    virtual bool isPolyphonic() const { return false; }
+    virtual void voiceOn(size_t /*voice*/) {}
+    virtual void voiceOff(size_t /*voice*/) {}
+    // still moving after voiceOff,e.g. an envelope in release
+    virtual bool isVoiceActive(size_t /*voice*/) const { return false; }
+    /**
+     * @brief Advance the voices of groups by numSamples,getVoiceOutput then holds their values
+     * @param index Parameters are read at this sample of the block
+    */
+    virtual void generateVoiceData(const size_t* /*groups*/, size_t /*numGroups*/,
+                                   size_t /*index*/, size_t /*numSamples*/) {}
+#if ! RPSYNTH_HEADLESS
     JUCE_NODISCARD virtual juce::Component* createControlComponent() = 0;
+#endif
     //=========================================================================
 
     //=========================================================================
@@ -46,27 +68,8 @@ public:
     }
 
     void process(size_t beginSamplePos, size_t endSamplePos) override {
-        // first generate all data
+        // ModulationMatrix adds data to parameter buffer
         this->generateData(beginSamplePos, endSamplePos);
-
-        // then add data to parameter buffer
-        for (ModulationSettings* set : m_parametersLinked) {
-            if (set->bypass) continue;
-
-            auto& buffer = set->target->m_output;
-            if (set->bipolar) {
-                for (size_t i = beginSamplePos; i < endSamplePos; ++i) {
-                    // [0,1] -> [-1,1]
-                    FType biAmount = static_cast<FType>(2) * m_outputBuffer[i]
-                        - static_cast<FType>(1);
-                    buffer[i] += biAmount * set->amount;
-                }
-            } else {
-                for (size_t i = beginSamplePos; i < endSamplePos; ++i) {
-                    buffer[i] += m_outputBuffer[i] * set->amount;
-                }
-            }
-        }
     }
 
     bool hasNoModulationTargets() const {
@@ -88,6 +91,7 @@ public:
         auto* m = new ModulationSettings(pTarget, this);
         pTarget->modulatorAdded(m);
         m_parametersLinked.add(m);
+        if (m_matrix != nullptr) m_matrix->rebuild();
     }
 
     /**
@@ -104,29 +108,45 @@ public:
 
         set->target->modulatorAdded(set);
         m_parametersLinked.add(set);
+        if (m_matrix != nullptr) m_matrix->rebuild();
     }
 
     void removeModulation(ModulationSettings* pMS) {
         pMS->target->modulatorRemoved(pMS);
-        m_parametersLinked.removeObject(pMS);
+        m_parametersLinked.removeObject(pMS, false);
+        releaseSettings(pMS);
+        if (m_matrix != nullptr) m_matrix->rebuild();
     }
 
     void removeAllModulations() {
         for (auto* link : m_parametersLinked) {
             link->target->m_modulationSettings.clear();
+            releaseSettings(link);
         }
 
-        m_parametersLinked.clear(true);
+        m_parametersLinked.clear(false);
+        if (m_matrix != nullptr) m_matrix->rebuild();
+    }
+
+    /**
+     * @brief Called by ModulationMatrix::addModulator,links are applied by the matrix from then on
+    */
+    void setModulationMatrix(ModulationMatrix* matrix) {
+        m_matrix = matrix;
     }
 
     FType getSampleRate() const {
         return m_sampleRate;
     }
 
-    std::vector<FType>& getOutputBuffer() {
+    SampleBuffer& getOutputBuffer() {
         return m_outputBuffer;
     }
 
+    const FType* getVoiceOutput() const {
+        return m_voiceOutput.data();
+    }
+
     int getNumModulations() const {
         return m_parametersLinked.size();
     }
@@ -149,9 +169,9 @@ public:
         for (auto* link : getAllModulationSettings()) {
             auto* setXML = modulationSettingsXML->createNewChildElement(g_myStrings.kParameterLinkTag);
             setXML->setAttribute("paramID", link->target->getParameterID());
-            setXML->setAttribute("bipolar", link->bipolar);
-            setXML->setAttribute("amount", link->amount);
-            setXML->setAttribute("bypass", link->bypass);
+            setXML->setAttribute("bipolar", link->bipolar.load());
+            setXML->setAttribute("amount", link->amount.load());
+            setXML->setAttribute("bypass", link->bypass.load());
         }
 
         saveExtraState(*modulatorXML);
@@ -175,6 +195,7 @@ public:
                 setting->bipolar = link->getBoolAttribute("bipolar");
                 setting->bypass = link->getBoolAttribute("bypass");
                 setting->amount = static_cast<FType>(link->getDoubleAttribute("amount"));
+                setting->snapAmount();
                 addModulation(setting);
             }
         }
@@ -186,9 +207,22 @@ protected:
     // SR
     FType m_sampleRate{};
 
+    // the audio thread may still read a removed link,so the matrix frees it later
+    void releaseSettings(ModulationSettings* set) {
+        if (m_matrix != nullptr) {
+            m_matrix->retire(std::unique_ptr<ModulationSettings>(set));
+        } else {
+            delete set;
+        }
+    }
+
     // modulations and output
     juce::OwnedArray<ModulationSettings> m_parametersLinked;
-    std::vector<FType> m_outputBuffer;
+    SampleBuffer m_outputBuffer;
+    ModulationMatrix* m_matrix = nullptr;
+
+    // value of every voice after the last generateVoiceData
+    alignas(16) std::array<FType, kMaxModulatorVoices> m_voiceOutput{};
 };
 }
 
@@ -10,6 +10,7 @@
 
 #pragma once
 #include <vector>
+#include "utils/BufferArena.h"
 
 namespace rpSynth::audio {
 using FType = float;
@@ -19,16 +20,35 @@ struct FPolyType {
     FType right;
 };
 
+// samples of one block,aligned and taken from the synthesizer's arena while preparing
+using SampleBuffer = AlignedBuffer<FType>;
+
 // stereo buffer
 struct StereoBuffer {
-    std::vector<FType> left;
-    std::vector<FType> right;
+    SampleBuffer left;
+    SampleBuffer right;
+
+    // right holds the same samples as left in the block being processed.
+    // Set by producers,a consumer may then work on left only and copyLeftToRight.
+    bool isMono = false;
+
+    // every sample of the block being processed is 0,a consumer may skip reading it
+    bool isSilent = false;
+
+    void copyLeftToRight(size_t begin, size_t end) {
+        std::copy(left.begin() + begin, left.begin() + end, right.begin() + begin);
+    }
 
     void clear() {
         std::ranges::fill(left, FType{});
         std::ranges::fill(right, FType{});
     }
 
+    void clear(size_t begin, size_t end) {
+        std::fill(left.begin() + begin, left.begin() + end, FType{});
+        std::fill(right.begin() + begin, right.begin() + end, FType{});
+    }
+
     void resize(size_t size) {
         left.resize(size, FType{});
         right.resize(size, FType{});
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    BufferArena.cpp
+    Created: 17 Oct 2026 8:05:41pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <new>
+#include "BufferArena.h"
+
+namespace rpSynth::audio {
+namespace detail {
+void AlignedDelete::operator()(std::byte* p) const noexcept {
+    ::operator delete[](p, std::align_val_t{BufferArena::kAlignment});
+}
+
+AlignedMemory allocateAligned(size_t numBytes) {
+    auto* p = static_cast<std::byte*>(::operator new[](numBytes, std::align_val_t{BufferArena::kAlignment}));
+    return AlignedMemory{p};
+}
+}
+
+void BufferArena::reset() {
+    if (m_chunks.size() > 1) {
+        const size_t numBytesNeeded = m_numBytesUsed;
+        m_chunks.clear();
+        addChunk(numBytesNeeded);
+    }
+    for (auto& chunk : m_chunks) {
+        chunk.used = 0;
+    }
+    m_numBytesUsed = 0;
+}
+
+void* BufferArena::allocate(size_t numBytes) {
+    const size_t size = getPaddedSize(numBytes);
+    if (m_chunks.empty() || m_chunks.back().used + size > m_chunks.back().size) {
+        addChunk(size);
+    }
+
+    auto& chunk = m_chunks.back();
+    void* p = chunk.memory.get() + chunk.used;
+    chunk.used += size;
+    m_numBytesUsed += size;
+    return p;
+}
+
+void BufferArena::addChunk(size_t numBytes) {
+    const size_t size = juce::jmax(getPaddedSize(numBytes), kMinChunkSize);
+    m_chunks.push_back(Chunk{detail::allocateAligned(size), size, 0});
+}
+}
@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    BufferArena.h
+    Created: 17 Oct 2026 8:05:41pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rpSynth::audio {
+namespace detail {
+struct AlignedDelete {
+    void operator()(std::byte* p) const noexcept;
+};
+using AlignedMemory = std::unique_ptr<std::byte[], AlignedDelete>;
+
+/**
+ * @brief numBytes of memory aligned to BufferArena::kAlignment
+*/
+AlignedMemory allocateAligned(size_t numBytes);
+}
+
+/**
+ * @brief Hands out aligned and padded slices of a few big chunks,so every buffer of a
+ *        synthesizer sits next to each other.Slices are never freed one by one,
+ *        reset() drops all of them at once.
+*/
+class BufferArena {
+public:
+    // one cache line,also the widest simd register
+    static constexpr size_t kAlignment = 64;
+    static constexpr size_t kMinChunkSize = 64 * 1024;
+
+    BufferArena() = default;
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    /**
+     * @brief Drop every slice.If the last round needed more than one chunk,they are
+     *        merged into one,so the next round of the same size is contiguous.
+    */
+    void reset();
+
+    /**
+     * @return kAlignment aligned memory,padded to a multiple of kAlignment
+    */
+    void* allocate(size_t numBytes);
+
+    static size_t getPaddedSize(size_t numBytes) {
+        return (numBytes + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    size_t getNumBytesUsed() const { return m_numBytesUsed; }
+private:
+    struct Chunk {
+        detail::AlignedMemory memory;
+        size_t size = 0;
+        size_t used = 0;
+    };
+    void addChunk(size_t numBytes);
+
+    std::vector<Chunk> m_chunks;
+    size_t m_numBytesUsed = 0;
+};
+
+/**
+ * @brief Every AlignedBuffer resized on this thread while it is alive takes its memory
+ *        from the arena,so processors need no knowledge of it in their prepare
+*/
+class ScopedBufferArena {
+public:
+    explicit ScopedBufferArena(BufferArena& arena)
+        : m_previous(s_current) {
+        s_current = &arena;
+    }
+
+    ~ScopedBufferArena() { s_current = m_previous; }
+
+    static BufferArena* getCurrent() { return s_current; }
+private:
+    inline static thread_local BufferArena* s_current = nullptr;
+    BufferArena* m_previous;
+};
+
+/**
+ * @brief A fixed size array of samples,aligned to BufferArena::kAlignment.
+ *        Takes a slice of the current ScopedBufferArena when resized,or owns
+ *        its memory when there is none.
+*/
+template<typename T>
+class AlignedBuffer {
+    static_assert(std::is_trivially_copyable_v<T>);
+public:
+    AlignedBuffer() = default;
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+        , m_ownedMemory(std::move(other.m_ownedMemory))
+        , m_ownedSize(std::exchange(other.m_ownedSize, 0)) {
+    }
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_ownedMemory = std::move(other.m_ownedMemory);
+        m_ownedSize = std::exchange(other.m_ownedSize, 0);
+        return *this;
+    }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    /**
+     * @brief Unlike std::vector,the old content is not kept,every element is set to value.
+     *        Only call it while preparing,it may allocate.
+    */
+    void resize(size_t numElements, T value = T{}) {
+        const size_t numBytes = numElements * sizeof(T);
+        if (auto* arena = ScopedBufferArena::getCurrent(); arena != nullptr) {
+            m_data = static_cast<T*>(arena->allocate(numBytes));
+            m_ownedMemory.reset();
+            m_ownedSize = 0;
+        } else if (m_ownedMemory == nullptr || numBytes > m_ownedSize) {
+            m_ownedSize = BufferArena::getPaddedSize(numBytes);
+            m_ownedMemory = detail::allocateAligned(m_ownedSize);
+            m_data = reinterpret_cast<T*>(m_ownedMemory.get());
+        } else {
+            m_data = reinterpret_cast<T*>(m_ownedMemory.get());
+        }
+        m_size = numElements;
+        std::fill(m_data, m_data + m_size, value);
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+    T* begin() { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+
+    T& operator[](size_t index) { return m_data[index]; }
+    const T& operator[](size_t index) const { return m_data[index]; }
+private:
+    T* m_data = nullptr;
+    size_t m_size = 0;
+    detail::AlignedMemory m_ownedMemory;
+    size_t m_ownedSize = 0;
+};
+}
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    LockFreePublisher.h
+    Created: 17 Oct 2026 9:14:02pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rpSynth::audio {
+/**
+ * @brief Hands immutable snapshots built on the message thread over to the audio thread.
+ *        The audio thread only loads a pointer and stores a number,it never locks,frees
+ *        or waits.Old snapshots,and anything retired with them,are freed on the message
+ *        thread once the audio thread has moved on to a newer snapshot.
+*/
+template<typename T>
+class LockFreePublisher {
+public:
+    LockFreePublisher() = default;
+    LockFreePublisher(const LockFreePublisher&) = delete;
+    LockFreePublisher& operator=(const LockFreePublisher&) = delete;
+
+    ~LockFreePublisher() {
+        delete m_current.load(std::memory_order_acquire);
+    }
+
+    //================================================================================
+    // message thread
+
+    /**
+     * @brief Replace the current snapshot,the old one is freed later
+    */
+    void publish(std::unique_ptr<T> snapshot) {
+        collectGarbage();
+
+        const auto generation = m_publishedGeneration + 1;
+        auto* node = new Node{generation, std::move(snapshot)};
+        auto* old = m_current.exchange(node, std::memory_order_acq_rel);
+        if (old != nullptr) {
+            retire(std::unique_ptr<Node>(old));
+        }
+        m_publishedGeneration = generation;
+    }
+
+    /**
+     * @brief Keep object alive until the audio thread is done with every snapshot
+     *        published so far.Call it before publishing the snapshot without it.
+    */
+    template<typename U>
+    void retire(std::unique_ptr<U> object) {
+        m_graveyard.push_back(Retired{m_publishedGeneration + 1,
+                                      RetiredPointer{object.release(), [](void* p) { delete static_cast<U*>(p); }}});
+    }
+
+    /**
+     * @brief Free everything the audio thread can no longer see
+    */
+    void collectGarbage() {
+        const auto seen = m_seenGeneration.load(std::memory_order_acquire);
+        std::erase_if(m_graveyard, [seen](const Retired& r) { return r.freeAfter <= seen; });
+    }
+    //================================================================================
+
+    //================================================================================
+    // audio thread
+
+    /**
+     * @brief Latest snapshot,or nullptr before the first publish.
+     *        Valid until the next call of acquire.
+    */
+    const T* acquire() noexcept {
+        auto* node = m_current.load(std::memory_order_acquire);
+        if (node == nullptr) return nullptr;
+        m_seenGeneration.store(node->generation, std::memory_order_release);
+        return node->snapshot.get();
+    }
+    //================================================================================
+private:
+    struct Node {
+        uint64_t generation;
+        std::unique_ptr<T> snapshot;
+    };
+
+    using RetiredPointer = std::unique_ptr<void, void(*)(void*)>;
+    struct Retired {
+        // free once the audio thread has seen this generation
+        uint64_t freeAfter;
+        RetiredPointer object;
+    };
+
+    std::atomic<Node*> m_current = nullptr;
+    std::atomic<uint64_t> m_seenGeneration = 0;
+    uint64_t m_publishedGeneration = 0;
+    std::vector<Retired> m_graveyard;
+};
+}
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    PitchKernels.h
+    Created: 17 Oct 2026 6:12:27pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <JuceHeader.h>
+
+#include "../../concepts.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#endif
+
+//================================================================================
+// Block kernels for semitone -> hertz / phase increment,without std::pow.
+// exp2 is split into 2^round(x) (built in the exponent bits) and 2^f,f in [-0.5,0.5],
+// which is a degree 6 polynomial (cephes exp2f).Relative error of semitoneToHertz
+// is below 1e-6 (about 0.002 cent) over the whole midi range.
+//================================================================================
+namespace rpSynth::audio::kernels {
+static_assert(std::is_same_v<FType, float>, "kernels are written for float");
+
+namespace detail {
+inline constexpr float kExp2P0 = 1.535336188319500e-4f;
+inline constexpr float kExp2P1 = 1.339887440266574e-3f;
+inline constexpr float kExp2P2 = 9.618437357674640e-3f;
+inline constexpr float kExp2P3 = 5.550332471162809e-2f;
+inline constexpr float kExp2P4 = 2.402264791363012e-1f;
+inline constexpr float kExp2P5 = 6.931472028550421e-1f;
+inline constexpr float kExp2Min = -126.f;
+inline constexpr float kExp2Max = 127.f;
+}
+
+/**
+ * @brief 2^x for one value
+*/
+inline float exp2(float x) noexcept {
+    x = juce::jlimit(detail::kExp2Min, detail::kExp2Max, x);
+    const float integer = std::nearbyint(x);
+    const float f = x - integer;
+
+    float p = detail::kExp2P0;
+    p = p * f + detail::kExp2P1;
+    p = p * f + detail::kExp2P2;
+    p = p * f + detail::kExp2P3;
+    p = p * f + detail::kExp2P4;
+    p = p * f + detail::kExp2P5;
+    const float fraction = p * f + 1.f;
+
+    const auto exponent = static_cast<int32_t>(integer) << 23;
+    return std::bit_cast<float>(std::bit_cast<int32_t>(fraction) + exponent);
+}
+
+/**
+ * @brief out[i] = 2^in[i],in and out may be the same buffer
+*/
+inline void exp2(const float* in, float* out, size_t numSamples) noexcept {
+    size_t i = 0;
+#if JUCE_USE_SSE_INTRINSICS
+    const __m128 minX = _mm_set1_ps(detail::kExp2Min);
+    const __m128 maxX = _mm_set1_ps(detail::kExp2Max);
+    const __m128 one = _mm_set1_ps(1.f);
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), minX), maxX);
+        // round to nearest,the default mxcsr mode
+        const __m128i integer = _mm_cvtps_epi32(x);
+        const __m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(integer));
+
+        __m128 p = _mm_set1_ps(detail::kExp2P0);
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(detail::kExp2P1));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(detail::kExp2P2));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(detail::kExp2P3));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(detail::kExp2P4));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(detail::kExp2P5));
+        const __m128 fraction = _mm_add_ps(_mm_mul_ps(p, f), one);
+
+        const __m128i exponent = _mm_slli_epi32(integer, 23);
+        _mm_storeu_ps(out + i, _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(fraction), exponent)));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        out[i] = exp2(in[i]);
+    }
+}
+
+/**
+ * @brief Same as rpSynth::semitoneToHertz for one value
+*/
+inline float semitoneToHertz(float semitone, float frequencyOfA = 440.f) noexcept {
+    return frequencyOfA * exp2((semitone - 69.f) * (1.f / 12.f));
+}
+
+/**
+ * @brief out[i] = frequencyOfA * 2^((semitone[i] - 69) / 12),semitone and out may be the same buffer.
+ *        Pass frequencyOfA = 440 / sampleRate to get phase increments instead of hertz.
+ *        A constant block is converted once.
+*/
+inline void semitoneToHertz(const float* semitone, float* out, size_t numSamples,
+                            float frequencyOfA = 440.f) noexcept {
+    if (numSamples == 0) return;
+
+    // exits at the second sample for almost every modulated or smoothing buffer
+    const float first = semitone[0];
+    if (std::all_of(semitone + 1, semitone + numSamples, [first](float v) { return v == first; })) {
+        juce::FloatVectorOperations::fill(out, semitoneToHertz(first, frequencyOfA), static_cast<int>(numSamples));
+        return;
+    }
+
+    // x = (st - 69) / 12
+    if (out != semitone) {
+        juce::FloatVectorOperations::copy(out, semitone, static_cast<int>(numSamples));
+    }
+    juce::FloatVectorOperations::add(out, -69.f, static_cast<int>(numSamples));
+    juce::FloatVectorOperations::multiply(out, 1.f / 12.f, static_cast<int>(numSamples));
+    exp2(out, out, numSamples);
+    juce::FloatVectorOperations::multiply(out, frequencyOfA, static_cast<int>(numSamples));
+}
+}
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    RangeKernels.h
+    Created: 17 Oct 2026 10:02:16pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "PitchKernels.h"
+
+//================================================================================
+// Block version of RangedAudioParameter::convertFrom0to1,which is
+// NormalisableRange::convertFrom0to1 and snapToLegalValue.A skewed range is
+// p^(1/skew) = 2^(log2(p)/skew),log2 is cephes logf scaled to base 2.
+//================================================================================
+namespace rpSynth::audio::kernels {
+namespace detail {
+inline constexpr float kLogP0 = 7.0376836292e-2f;
+inline constexpr float kLogP1 = -1.1514610310e-1f;
+inline constexpr float kLogP2 = 1.1676998740e-1f;
+inline constexpr float kLogP3 = -1.2420140846e-1f;
+inline constexpr float kLogP4 = 1.4249322787e-1f;
+inline constexpr float kLogP5 = -1.6668057665e-1f;
+inline constexpr float kLogP6 = 2.0000714765e-1f;
+inline constexpr float kLogP7 = -2.4999993993e-1f;
+inline constexpr float kLogP8 = 3.3333331174e-1f;
+inline constexpr float kSqrtHalf = 0.707106781186547524f;
+inline constexpr float kLog2E = 1.44269504088896341f;
+}
+
+/**
+ * @brief log2(x) for one value,x > 0.Returns -127 for 0.
+*/
+inline float log2(float x) noexcept {
+    // x = m * 2^e,m in [sqrt(0.5),sqrt(2))
+    const auto bits = std::bit_cast<int32_t>(x);
+    auto exponent = static_cast<float>(((bits >> 23) & 0xff) - 126);
+    float m = std::bit_cast<float>((bits & 0x007fffff) | 0x3f000000); // [0.5,1)
+    if (m < detail::kSqrtHalf) {
+        m += m;
+        exponent -= 1.f;
+    }
+    const float t = m - 1.f;
+
+    float p = detail::kLogP0;
+    p = p * t + detail::kLogP1;
+    p = p * t + detail::kLogP2;
+    p = p * t + detail::kLogP3;
+    p = p * t + detail::kLogP4;
+    p = p * t + detail::kLogP5;
+    p = p * t + detail::kLogP6;
+    p = p * t + detail::kLogP7;
+    p = p * t + detail::kLogP8;
+    const float z = t * t;
+    const float ln = t + (t * z * p - 0.5f * z);
+    return ln * detail::kLog2E + exponent;
+}
+
+/**
+ * @brief out[i] = log2(in[i]),in and out may be the same buffer
+*/
+inline void log2(const float* in, float* out, size_t numSamples) noexcept {
+    size_t i = 0;
+#if JUCE_USE_SSE_INTRINSICS
+    const __m128i exponentMask = _mm_set1_epi32(0xff);
+    const __m128i exponentBias = _mm_set1_epi32(126);
+    const __m128i mantissaMask = _mm_set1_epi32(0x007fffff);
+    const __m128i half = _mm_set1_epi32(0x3f000000);
+    const __m128 sqrtHalf = _mm_set1_ps(detail::kSqrtHalf);
+    const __m128 one = _mm_set1_ps(1.f);
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128i bits = _mm_castps_si128(_mm_loadu_ps(in + i));
+        __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), exponentMask),
+                                                        exponentBias));
+        __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissaMask), half));
+
+        // m < sqrt(0.5): m = 2m,exponent - 1
+        const __m128 below = _mm_cmplt_ps(m, sqrtHalf);
+        m = _mm_add_ps(m, _mm_and_ps(below, m));
+        exponent = _mm_sub_ps(exponent, _mm_and_ps(below, one));
+        const __m128 t = _mm_sub_ps(m, one);
+
+        __m128 p = _mm_set1_ps(detail::kLogP0);
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(detail::kLogP1));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(detail::kLogP2));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(detail::kLogP3));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(detail::kLogP4));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(detail::kLogP5));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(detail::kLogP6));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(detail::kLogP7));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(detail::kLogP8));
+        const __m128 z = _mm_mul_ps(t, t);
+        const __m128 y = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(t, z), p), _mm_mul_ps(_mm_set1_ps(0.5f), z));
+        const __m128 ln = _mm_add_ps(t, y);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(ln, _mm_set1_ps(detail::kLog2E)), exponent));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        out[i] = log2(in[i]);
+    }
+}
+
+/**
+ * @brief Precomputed form of a juce::NormalisableRange for converting whole blocks.
+ *        A range with custom conversion functions or a symmetric skew goes through
+ *        the range itself,sample by sample.
+*/
+class RangeConverter {
+public:
+    RangeConverter() = default;
+
+    explicit RangeConverter(const juce::NormalisableRange<float>& range)
+        : m_range(&range)
+        , m_start(range.start)
+        , m_end(range.end)
+        , m_length(range.end - range.start)
+        , m_interval(range.interval)
+        , m_invSkew(1.f / range.skew)
+        , m_isSkewed(range.skew != 1.f) {
+        // custom lambdas are private in NormalisableRange,so compare a few points instead
+        m_useRange = range.symmetricSkew;
+        for (float p : {0.f, 0.1f, 0.25f, 0.5f, 0.75f, 1.f}) {
+            const float expected = range.snapToLegalValue(range.convertFrom0to1(p));
+            float got{};
+            convertFrom0to1(&p, &got, 1);
+            if (std::abs(expected - got) > juce::jmax(m_interval, std::abs(m_length) * 1e-4f)) {
+                m_useRange = true;
+            }
+        }
+    }
+
+    /**
+     * @brief out[i] = value of normalized in[i],in and out may be the same buffer
+    */
+    void convertFrom0to1(const float* in, float* out, size_t numSamples) const noexcept {
+        const auto num = static_cast<int>(numSamples);
+        if (m_range == nullptr) {
+            if (out != in) juce::FloatVectorOperations::copy(out, in, num);
+            return;
+        }
+        if (m_useRange) {
+            for (size_t i = 0; i < numSamples; i++) {
+                out[i] = m_range->snapToLegalValue(m_range->convertFrom0to1(juce::jlimit(0.f, 1.f, in[i])));
+            }
+            return;
+        }
+
+        juce::FloatVectorOperations::clip(out, in, 0.f, 1.f, num);
+        if (m_isSkewed) {
+            // p^(1/skew),0 comes out as 2^-126 which is start after the mapping
+            log2(out, out, numSamples);
+            juce::FloatVectorOperations::multiply(out, m_invSkew, num);
+            exp2(out, out, numSamples);
+        }
+        juce::FloatVectorOperations::multiply(out, m_length, num);
+        juce::FloatVectorOperations::add(out, m_start, num);
+
+        if (m_interval > 0.f) {
+            // (v - start) / interval + 0.5 >= 0.5,so truncating is floor
+            for (size_t i = 0; i < numSamples; i++) {
+                const auto steps = static_cast<int32_t>((out[i] - m_start) / m_interval + 0.5f);
+                out[i] = juce::jlimit(m_start, m_end, m_start + m_interval * static_cast<float>(steps));
+            }
+        }
+    }
+private:
+    const juce::NormalisableRange<float>* m_range = nullptr;
+    float m_start{};
+    float m_end{};
+    float m_length{};
+    float m_interval{};
+    float m_invSkew{};
+    bool m_isSkewed = false;
+    bool m_useRange = false;
+};
+}
@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    RealtimeWorkerPool.cpp
+    Created: 17 Oct 2026 3:02:48pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#include <thread>
+#include <JuceHeader.h>
+#include "RealtimeWorkerPool.h"
+
+namespace rpSynth::audio {
+// long enough to cover the gap between two dispatches of one block,
+// short enough to not burn a core while the host is idle
+static constexpr int kNumSpinsBeforeSleep = 256;
+
+// the audio thread waits on these,so they run at real-time priority like it does
+class RealtimeWorkerPool::Worker : public juce::Thread {
+public:
+    explicit Worker(RealtimeWorkerPool& pool)
+        : juce::Thread("rpSynth worker"), m_pool(pool) {
+        // not every system lets a plugin make real-time threads,highest is the next best
+        if (!startRealtimeThread(juce::Thread::RealtimeOptions{})) {
+            startThread(juce::Thread::Priority::highest);
+        }
+    }
+
+    void run() override { m_pool.workerLoop(); }
+private:
+    RealtimeWorkerPool& m_pool;
+};
+
+RealtimeWorkerPool::RealtimeWorkerPool(size_t numWorkers) {
+    m_workers.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; i++) {
+        m_workers.push_back(std::make_unique<Worker>(*this));
+    }
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool() {
+    m_shouldExit = true;
+    m_state.fetch_add(makeState(1, 0, 0), std::memory_order_release);
+    m_state.notify_all();
+
+    for (auto& w : m_workers) {
+        w->waitForThreadToExit(-1);
+    }
+}
+
+void RealtimeWorkerPool::run(Job& job, size_t numJobs) {
+    start(job, numJobs);
+    wait();
+}
+
+void RealtimeWorkerPool::start(Job& job, size_t numJobs) {
+    jassert(numJobs <= kMaxJobs);
+    jassert(m_numJobsDone.load(std::memory_order_acquire) == m_numJobs);
+
+    // publish
+    m_job = &job;
+    m_numJobs = numJobs;
+    m_numJobsDone.store(0, std::memory_order_relaxed);
+    auto generation = getGeneration(m_state.load(std::memory_order_relaxed)) + 1;
+    m_state.store(makeState(generation, numJobs, 0), std::memory_order_release);
+    m_state.notify_all();
+}
+
+void RealtimeWorkerPool::wait() {
+    // help,a job that no worker has taken yet is faster done here than waited for
+    auto state = m_state.load(std::memory_order_acquire);
+    while (tryRunOneJob(state)) {}
+
+    for (int spin = 0; spin < kNumSpinsBeforeSleep; spin++) {
+        if (m_numJobsDone.load(std::memory_order_acquire) == m_numJobs) return;
+        std::this_thread::yield();
+    }
+    for (auto done = m_numJobsDone.load(std::memory_order_acquire);
+         done != m_numJobs;
+         done = m_numJobsDone.load(std::memory_order_acquire)) {
+        m_numJobsDone.wait(done, std::memory_order_acquire);
+    }
+}
+
+bool RealtimeWorkerPool::tryRunOneJob(uint64_t& state) {
+    while (getNextJob(state) < getNumJobs(state)) {
+        if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel)) {
+            // the job is not done yet,so m_job still belongs to this generation
+            auto numJobs = getNumJobs(state);
+            m_job->runJob(getNextJob(state));
+            if (m_numJobsDone.fetch_add(1, std::memory_order_acq_rel) + 1 == numJobs) {
+                m_numJobsDone.notify_one();
+            }
+            state = m_state.load(std::memory_order_acquire);
+            return true;
+        }
+    }
+    return false;
+}
+
+void RealtimeWorkerPool::workerLoop() {
+    auto state = m_state.load(std::memory_order_acquire);
+    while (!m_shouldExit.load(std::memory_order_acquire)) {
+        if (tryRunOneJob(state)) continue;
+
+        // nothing to do,wait for next generation
+        int spin = 0;
+        for (; spin < kNumSpinsBeforeSleep; spin++) {
+            auto newState = m_state.load(std::memory_order_acquire);
+            if (newState != state) {
+                state = newState;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if (spin == kNumSpinsBeforeSleep) {
+            m_state.wait(state, std::memory_order_acquire);
+            state = m_state.load(std::memory_order_acquire);
+        }
+    }
+}
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    RealtimeWorkerPool.h
+    Created: 17 Oct 2026 3:02:48pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace rpSynth::audio {
+/**
+ * @brief A fixed set of real-time threads spawned up front,used by the audio
+ *        thread to split one block of work.Dispatching never locks or allocates,
+ *        idle workers spin for a short while and then sleep on a futex.
+*/
+class RealtimeWorkerPool {
+public:
+    class Job {
+    public:
+        virtual ~Job() = default;
+        virtual void runJob(size_t jobIndex) = 0;
+    };
+
+    static constexpr size_t kMaxJobs = 0xffff;
+
+    explicit RealtimeWorkerPool(size_t numWorkers);
+    ~RealtimeWorkerPool();
+
+    size_t getNumWorkers() const { return m_workers.size(); }
+
+    /**
+     * @brief Run job.runJob(0 ~ numJobs-1) on the workers and the calling thread.
+     *        Returns after every job is done.Jobs may run in any order.
+    */
+    void run(Job& job, size_t numJobs);
+
+    /**
+     * @brief Like run,but returns at once so the workers start while the caller
+     *        does something else.Call wait() before starting anything else on this pool.
+    */
+    void start(Job& job, size_t numJobs);
+
+    /**
+     * @brief Block until every job of the last start() is done.
+     *        Jobs no worker has taken yet are run on the calling thread,so it
+     *        only sleeps on jobs that are already running.
+    */
+    void wait();
+private:
+    class Worker;
+
+    void workerLoop();
+    bool tryRunOneJob(uint64_t& state);
+
+    // state = generation(32 bits) | numJobs(16 bits) | nextJob(16 bits)
+    // a job is claimed by a CAS on the whole word,so a worker that wakes up
+    // late can never claim a job of another generation
+    static uint64_t makeState(uint64_t generation, uint64_t numJobs, uint64_t nextJob) {
+        return (generation << 32) | (numJobs << 16) | nextJob;
+    }
+    static uint64_t getGeneration(uint64_t state) { return state >> 32; }
+    static uint64_t getNumJobs(uint64_t state) { return (state >> 16) & kMaxJobs; }
+    static uint64_t getNextJob(uint64_t state) { return state & kMaxJobs; }
+
+    std::atomic<uint64_t> m_state = 0;
+    std::atomic<size_t> m_numJobsDone = 0;
+    size_t m_numJobs = 0;
+    std::atomic<bool> m_shouldExit = false;
+    Job* m_job = nullptr;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+}
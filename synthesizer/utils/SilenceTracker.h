@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    SilenceTracker.h
+    Created: 17 Oct 2026 11:58:12pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+#include <JuceHeader.h>
+#include "synthesizer/types.h"
+
+namespace rpSynth::audio {
+/**
+ * @brief Decides when a stage may sleep: its input is silent and its own output
+ *        stayed below kThreshold for kHoldTimeInSeconds.A sleeping stage skips
+ *        processing and outputs silence until its input is not silent any more.
+*/
+class SilenceTracker {
+public:
+    static constexpr FType kThreshold = static_cast<FType>(1e-5); // -100dB
+    // longer than any delay line of the stages,so a quiet block is not a gap between echoes
+    static constexpr FType kHoldTimeInSeconds = static_cast<FType>(0.1);
+
+    void prepare(FType sampleRate) {
+        m_holdSamples = static_cast<size_t>(kHoldTimeInSeconds * sampleRate);
+        wake();
+    }
+
+    void wake() {
+        m_isSleeping = false;
+        m_quietSamples = 0;
+    }
+
+    bool isSleeping() const { return m_isSleeping; }
+
+    /**
+     * @brief Call before processing a block
+     * @return True when the stage skips the block,its output is silent
+    */
+    bool canSkip(bool isInputSilent) {
+        if (!isInputSilent) wake();
+        return m_isSleeping;
+    }
+
+    /**
+     * @brief Call after processing [begin,end) of output
+     * @return True when the stage just fell asleep,clear its state now
+    */
+    bool update(bool isInputSilent, const StereoBuffer& output, size_t begin, size_t end) {
+        if (!isInputSilent || !isBelowThreshold(output, begin, end)) {
+            m_quietSamples = 0;
+            return false;
+        }
+        m_quietSamples += end - begin;
+        if (m_quietSamples < m_holdSamples) return false;
+
+        m_isSleeping = true;
+        return true;
+    }
+
+    static bool isBelowThreshold(const StereoBuffer& buffer, size_t begin, size_t end) {
+        if (buffer.isSilent) return true;
+        const auto num = static_cast<int>(end - begin);
+        auto isQuiet = [num, begin](const SampleBuffer& channel) {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(channel.data() + begin, num);
+            return range.getStart() > -kThreshold && range.getEnd() < kThreshold;
+        };
+        return isQuiet(buffer.left) && (buffer.isMono || isQuiet(buffer.right));
+    }
+
+    /**
+     * @brief Seconds until full scale in a feedback loop decays below kThreshold
+     * @param loopSeconds Time of one trip around the loop
+    */
+    static double feedbackTailSeconds(double loopSeconds, double feedback) {
+        const double gain = juce::jlimit(1e-3, 0.999, std::abs(feedback));
+        return loopSeconds * std::log(static_cast<double>(kThreshold)) / std::log(gain);
+    }
+private:
+    size_t m_holdSamples = 0;
+    size_t m_quietSamples = 0;
+    bool m_isSleeping = false;
+};
+}
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    SimdLane.h
+    Created: 17 Oct 2026 11:21:37pm
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+
+namespace rpSynth::audio {
+/**
+ * @brief Four floats in one SSE register,e.g. left and right of a stereo filter.
+ *        Unlike juce::dsp::SIMDRegister it divides,which the filter kernels need.
+ *        Falls back to a plain array without SSE.
+*/
+struct FloatLane {
+    static constexpr size_t kNumElements = 4;
+
+#if JUCE_USE_SSE_INTRINSICS
+    __m128 value;
+
+    static FloatLane expand(float s) noexcept { return {_mm_set1_ps(s)}; }
+    static FloatLane fromStereo(float left, float right) noexcept { return {_mm_setr_ps(left, right, 0.f, 0.f)}; }
+    static FloatLane load(const float* p) noexcept { return {_mm_loadu_ps(p)}; }
+    void store(float* p) const noexcept { _mm_storeu_ps(p, value); }
+
+    /**
+     * @brief Sum of all elements
+    */
+    float sum() const noexcept {
+        const __m128 pairs = _mm_add_ps(value, _mm_movehl_ps(value, value));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1))));
+    }
+
+    /**
+     * @brief Element index in every lane
+    */
+    template<int index>
+    FloatLane broadcast() const noexcept { return {_mm_shuffle_ps(value, value, _MM_SHUFFLE(index, index, index, index))}; }
+
+    template<int index>
+    float get() const noexcept { return _mm_cvtss_f32(broadcast<index>().value); }
+
+    friend FloatLane operator+(FloatLane a, FloatLane b) noexcept { return {_mm_add_ps(a.value, b.value)}; }
+    friend FloatLane operator-(FloatLane a, FloatLane b) noexcept { return {_mm_sub_ps(a.value, b.value)}; }
+    friend FloatLane operator*(FloatLane a, FloatLane b) noexcept { return {_mm_mul_ps(a.value, b.value)}; }
+    friend FloatLane operator/(FloatLane a, FloatLane b) noexcept { return {_mm_div_ps(a.value, b.value)}; }
+    static FloatLane min(FloatLane a, FloatLane b) noexcept { return {_mm_min_ps(a.value, b.value)}; }
+    static FloatLane max(FloatLane a, FloatLane b) noexcept { return {_mm_max_ps(a.value, b.value)}; }
+#else
+    std::array<float, kNumElements> value;
+
+    static FloatLane expand(float s) noexcept { return {{s, s, s, s}}; }
+    static FloatLane fromStereo(float left, float right) noexcept { return {{left, right, 0.f, 0.f}}; }
+    static FloatLane load(const float* p) noexcept { return {{p[0], p[1], p[2], p[3]}}; }
+    void store(float* p) const noexcept { std::copy(value.begin(), value.end(), p); }
+    float sum() const noexcept { return (value[0] + value[2]) + (value[1] + value[3]); }
+
+    template<int index>
+    FloatLane broadcast() const noexcept { return expand(value[index]); }
+
+    template<int index>
+    float get() const noexcept { return value[index]; }
+
+    friend FloatLane operator+(FloatLane a, FloatLane b) noexcept { return apply(a, b, [](float x, float y) { return x + y; }); }
+    friend FloatLane operator-(FloatLane a, FloatLane b) noexcept { return apply(a, b, [](float x, float y) { return x - y; }); }
+    friend FloatLane operator*(FloatLane a, FloatLane b) noexcept { return apply(a, b, [](float x, float y) { return x * y; }); }
+    friend FloatLane operator/(FloatLane a, FloatLane b) noexcept { return apply(a, b, [](float x, float y) { return x / y; }); }
+    static FloatLane min(FloatLane a, FloatLane b) noexcept { return apply(a, b, [](float x, float y) { return juce::jmin(x, y); }); }
+    static FloatLane max(FloatLane a, FloatLane b) noexcept { return apply(a, b, [](float x, float y) { return juce::jmax(x, y); }); }
+
+    template<typename Op>
+    static FloatLane apply(FloatLane a, FloatLane b, Op op) noexcept {
+        FloatLane r;
+        for (size_t i = 0; i < kNumElements; i++) {
+            r.value[i] = op(a.value[i], b.value[i]);
+        }
+        return r;
+    }
+#endif
+
+    float left() const noexcept { return get<0>(); }
+    float right() const noexcept { return get<1>(); }
+
+    friend FloatLane operator-(FloatLane a) noexcept { return expand(0.f) - a; }
+    FloatLane& operator+=(FloatLane b) noexcept { return *this = *this + b; }
+    FloatLane& operator-=(FloatLane b) noexcept { return *this = *this - b; }
+    FloatLane& operator*=(FloatLane b) noexcept { return *this = *this * b; }
+};
+
+namespace kernels {
+/**
+ * @brief juce::dsp::FastMathApproximations::tanh for every lane
+*/
+inline FloatLane tanh(FloatLane x) noexcept {
+    const auto x2 = x * x;
+    const auto numerator = -x * (FloatLane::expand(135135.f)
+                                 + x2 * (FloatLane::expand(17325.f) + x2 * (FloatLane::expand(378.f) + x2)));
+    const auto denominator = FloatLane::expand(-135135.f)
+        + x2 * (FloatLane::expand(-62370.f) + x2 * (FloatLane::expand(-3150.f) + FloatLane::expand(-28.f) * x2));
+    return numerator / denominator;
+}
+
+/**
+ * @brief Above limit: limit + (x - limit) * k,below -limit the same mirrored
+*/
+inline FloatLane softLimit(FloatLane x, FloatLane limit, FloatLane oneMinusK) noexcept {
+    const auto zero = FloatLane::expand(0.f);
+    x -= oneMinusK * FloatLane::max(x - limit, zero);
+    x -= oneMinusK * FloatLane::min(x + limit, zero);
+    return x;
+}
+}
+}
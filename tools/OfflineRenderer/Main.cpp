@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 9:40:02am
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "synthesizer/BasicSynthesizer.h"
+#include "tools/common/HeadlessHost.h"
+
+//================================================================================
+// Offline renderer: midi file + preset -> wav
+// Drives BasicSynthesizer::processBlock exactly like the plugin does,
+// so it is also used to measure throughput on render machines.
+//================================================================================
+namespace {
+constexpr double kDefaultSampleRate = 48000.0;
+constexpr int kDefaultBlockSize = 512;
+constexpr double kDefaultTailSeconds = 2.0;
+constexpr int kDefaultBitDepth = 24;
+
+void printUsage() {
+    std::cout << "RPBasicSynthesizer offline renderer\n"
+        "usage: OfflineRenderer --midi <file.mid> --output <file.wav> [options]\n"
+        "  --preset <file.xml>   preset saved by the plugin (default: init patch)\n"
+        "  --samplerate <hz>     default " << kDefaultSampleRate << "\n"
+        "  --blocksize <n>       samples per processBlock call, default " << kDefaultBlockSize << "\n"
+        "  --tail <seconds>      extra render time after the last midi event, default " << kDefaultTailSeconds << "\n"
+        "  --bitdepth <16|24|32> default " << kDefaultBitDepth << "\n"
+        "  --multithread         render voices on a worker pool\n"
+        "  --pipeline            run filter and fx on a helper thread (latency is compensated)\n"
+        "  --minslice <n>        midi events closer than this are rendered together, 0 is sample exact\n"
+        "  --microblock <n>      samples processed at once inside a block, 16 to 1024\n";
+}
+
+juce::MidiMessageSequence readMidiFile(const juce::File& file, bool& ok) {
+    juce::MidiMessageSequence sequence;
+    juce::FileInputStream in{file};
+    juce::MidiFile midiFile;
+    ok = in.openedOk() && midiFile.readFrom(in);
+    if (!ok) return sequence;
+
+    // merge all tracks into one time line in seconds
+    midiFile.convertTimestampTicksToSeconds();
+    for (int i = 0; i < midiFile.getNumTracks(); i++) {
+        sequence.addSequence(*midiFile.getTrack(i), 0.0);
+    }
+    sequence.updateMatchedPairs();
+    return sequence;
+}
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args{argc, argv};
+
+    if (args.containsOption("--help|-h") || !args.containsOption("--midi") || !args.containsOption("--output")) {
+        printUsage();
+        return 1;
+    }
+
+    const auto midiPath = args.getFileForOption("--midi");
+    const auto outputPath = args.getFileForOption("--output");
+    const double sampleRate = args.containsOption("--samplerate")
+        ? args.getValueForOption("--samplerate").getDoubleValue() : kDefaultSampleRate;
+    const int blockSize = args.containsOption("--blocksize")
+        ? args.getValueForOption("--blocksize").getIntValue() : kDefaultBlockSize;
+    const double tailSeconds = args.containsOption("--tail")
+        ? args.getValueForOption("--tail").getDoubleValue() : kDefaultTailSeconds;
+    const int bitDepth = args.containsOption("--bitdepth")
+        ? args.getValueForOption("--bitdepth").getIntValue() : kDefaultBitDepth;
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || tailSeconds < 0.0) {
+        std::cerr << "invalid samplerate, blocksize or tail\n";
+        return 1;
+    }
+
+    // load midi
+    bool midiOk = false;
+    auto sequence = readMidiFile(midiPath, midiOk);
+    if (!midiOk) {
+        std::cerr << "can not read midi file: " << midiPath.getFullPathName() << "\n";
+        return 1;
+    }
+
+    // build engine,ID must be the same as the plugin's or presets won't match
+    rpSynth::audio::BasicSynthesizer synth{"synth"};
+    rpSynth::tools::HeadlessHost host{synth};
+    if (args.containsOption("--preset")) {
+        auto presetPath = args.getFileForOption("--preset");
+        if (!host.loadPreset(presetPath)) {
+            std::cerr << "can not load preset: " << presetPath.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    synth.m_polyOscillor.setMultithreadedRendering(args.containsOption("--multithread"));
+    synth.setPipelinedProcessing(args.containsOption("--pipeline"));
+    if (args.containsOption("--minslice")) {
+        synth.setMinimumSliceSamples(static_cast<size_t>(juce::jmax(0, args.getValueForOption("--minslice").getIntValue())));
+    }
+    if (args.containsOption("--microblock")) {
+        synth.setMicroBlockSize(static_cast<size_t>(juce::jmax(0, args.getValueForOption("--microblock").getIntValue())));
+    }
+
+    synth.prepare(static_cast<rpSynth::audio::FType>(sampleRate), static_cast<size_t>(blockSize));
+    synth.prepareParameters(static_cast<rpSynth::audio::FType>(sampleRate), static_cast<size_t>(blockSize));
+
+    // open output
+    outputPath.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream = outputPath.createOutputStream();
+    if (stream == nullptr) {
+        std::cerr << "can not write: " << outputPath.getFullPathName() << "\n";
+        return 1;
+    }
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer{
+        wavFormat.createWriterFor(stream.get(), sampleRate, 2, bitDepth, {}, 0)};
+    if (writer == nullptr) {
+        std::cerr << "unsupported wav format\n";
+        return 1;
+    }
+    stream.release(); // writer owns the stream now
+
+    // render,the first latency samples are dropped
+    const auto latency = static_cast<juce::int64>(synth.getLatencySamples());
+    const auto totalSamples = static_cast<juce::int64>((sequence.getEndTime() + tailSeconds) * sampleRate);
+    const auto totalSamplesToRender = totalSamples + latency;
+    juce::AudioBuffer<float> buffer{2, blockSize};
+    juce::MidiBuffer midiBuffer;
+    int nextEvent = 0;
+    juce::int64 processTicks = 0;
+
+    juce::ScopedNoDenormals noDenormals;
+    for (juce::int64 blockStart = 0; blockStart < totalSamplesToRender; blockStart += blockSize) {
+        const int numSamples = static_cast<int>(juce::jmin<juce::int64>(blockSize, totalSamplesToRender - blockStart));
+        const auto blockEnd = blockStart + numSamples;
+
+        // collect midi events of this block
+        midiBuffer.clear();
+        for (; nextEvent < sequence.getNumEvents(); nextEvent++) {
+            const auto& message = sequence.getEventPointer(nextEvent)->message;
+            auto position = static_cast<juce::int64>(message.getTimeStamp() * sampleRate);
+            if (position >= blockEnd) break;
+            if (message.isMetaEvent()) continue;
+            midiBuffer.addEvent(message, static_cast<int>(juce::jmax<juce::int64>(0, position - blockStart)));
+        }
+
+        // last block may be shorter
+        juce::AudioBuffer<float> block{buffer.getArrayOfWritePointers(), 2, numSamples};
+        block.clear();
+
+        auto begin = juce::Time::getHighResolutionTicks();
+        synth.processBlock(midiBuffer, block);
+        processTicks += juce::Time::getHighResolutionTicks() - begin;
+
+        const auto skip = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, latency - blockStart));
+        if (skip < numSamples) {
+            writer->writeFromAudioSampleBuffer(block, skip, numSamples - skip);
+        }
+    }
+    writer = nullptr;
+
+    // report
+    const double audioSeconds = static_cast<double>(totalSamples) / sampleRate;
+    const double processSeconds = juce::Time::highResolutionTicksToSeconds(processTicks);
+    std::cout << "rendered:        " << audioSeconds << " s (" << totalSamples << " samples)\n"
+        << "sample rate:     " << sampleRate << " hz, block size " << blockSize
+        << ", micro block " << synth.getMicroBlockSize() << "\n"
+        << "process time:    " << processSeconds << " s\n"
+        << "realtime factor: " << (processSeconds > 0.0 ? audioSeconds / processSeconds : 0.0) << "x\n";
+    return 0;
+}
@@ -0,0 +1,313 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 11:05:31am
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "synthesizer/BasicSynthesizer.h"
+#include "synthesizer/Filter/Filters/LowPass.h"
+#include "synthesizer/Filter/Filters/HighPass.h"
+#include "synthesizer/Filter/Filters/Analog/MoogLadderFilter.h"
+#include "tools/common/HeadlessHost.h"
+
+//================================================================================
+// Per processor micro benchmark
+// Every stage is driven through the AudioProcessorBase interface:
+// prepare -> updateParameters -> process,the same order BasicSynthesizer uses.
+//================================================================================
+namespace rpSynth::tools {
+using audio::FType;
+
+static constexpr size_t kBlockSizes[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+static constexpr FType kSampleRates[] = {44100, 48000, 88200, 96000, 176400, 192000};
+static constexpr size_t kModulationLinks[] = {0, 1, 4, 16, 64};
+static constexpr size_t kMaxModulationLinks = 64;
+
+//================================================================================
+// A stereo white noise input for filters and effects
+//================================================================================
+class NoiseSource : public audio::AudioProcessorBase {
+public:
+    using AudioProcessorBase::AudioProcessorBase;
+
+    audio::StereoBuffer* getOutputBuffer() { return &m_outputBuffer; }
+
+    void addParameterToLayout(juce::AudioProcessorValueTreeState::ParameterLayout&) override {}
+    void updateParameters(size_t) override {}
+    void prepareParameters(FType, size_t) override {}
+    void prepare(FType, size_t numSamples) override {
+        m_outputBuffer.resize(numSamples);
+        juce::Random random{1234};
+        for (size_t i = 0; i < numSamples; i++) {
+            m_outputBuffer.left[i] = random.nextFloat() * 2.f - 1.f;
+            m_outputBuffer.right[i] = random.nextFloat() * 2.f - 1.f;
+        }
+    }
+    void process(size_t, size_t) override {}
+    void saveExtraState(juce::XmlElement&) override {}
+    void loadExtraState(juce::XmlElement&, juce::AudioProcessorValueTreeState&) override {}
+private:
+    audio::StereoBuffer m_outputBuffer;
+};
+
+//================================================================================
+// Modulation targets,so a modulator can be linked to N parameters
+//================================================================================
+class ParameterBank : public audio::AudioProcessorBase {
+public:
+    using AudioProcessorBase::AudioProcessorBase;
+
+    audio::MyAudioProcessParameter& getParameter(size_t index) { return m_parameters[index]; }
+
+    void addParameterToLayout(juce::AudioProcessorValueTreeState::ParameterLayout& layout) override {
+        for (size_t i = 0; auto & p : m_parameters) {
+            auto name = "p" + juce::String{i++};
+            layout.add(std::make_unique<audio::MyHostedAudioProcessorParameter>(&p,
+                                                                                combineWithID(name),
+                                                                                name,
+                                                                                juce::NormalisableRange<float>(0.f, 1.f),
+                                                                                0.5f));
+        }
+    }
+    void updateParameters(size_t numSamples) override {
+        for (auto& p : m_parameters) p.updateParameter(numSamples);
+    }
+    void prepareParameters(FType sampleRate, size_t numSamples) override {
+        for (auto& p : m_parameters) p.prepare(sampleRate, numSamples);
+    }
+    void prepare(FType, size_t) override {}
+    void process(size_t, size_t) override {}
+    void saveExtraState(juce::XmlElement&) override {}
+    void loadExtraState(juce::XmlElement&, juce::AudioProcessorValueTreeState&) override {}
+private:
+    std::array<audio::MyAudioProcessParameter, kMaxModulationLinks> m_parameters;
+};
+
+//================================================================================
+// Cases
+//================================================================================
+class BenchmarkCase {
+public:
+    virtual ~BenchmarkCase() = default;
+    virtual juce::String getName() const = 0;
+    virtual void prepare(FType sampleRate, size_t blockSize) = 0;
+    virtual void processBlock(size_t numSamples) = 0;
+};
+
+class OscillatorCase : public BenchmarkCase {
+public:
+    OscillatorCase(size_t numVoices, bool multithreaded) : m_numVoices(numVoices) {
+        m_oscillor.setMultithreadedRendering(multithreaded);
+    }
+
+    juce::String getName() const override {
+        return "PolyOscillor/" + juce::String{m_numVoices} + "voices"
+            + (m_oscillor.isMultithreadedRendering() ? "/Multithread" : "");
+    }
+
+    void prepare(FType sampleRate, size_t blockSize) override {
+        m_oscillor.setPolyphony(m_numVoices);
+        m_oscillor.prepare(sampleRate, blockSize);
+        m_oscillor.prepareParameters(sampleRate, blockSize);
+        for (size_t i = 0; i < m_numVoices; i++) {
+            m_oscillor.noteOn(1, 24 + static_cast<int>(i), 0.8f);
+        }
+    }
+
+    void processBlock(size_t numSamples) override {
+        m_oscillor.updateParameters(numSamples);
+        m_oscillor.beginMicroBlock(0);
+        m_oscillor.process(0, numSamples);
+        m_oscillor.renderSpan();
+    }
+private:
+    size_t m_numVoices;
+    audio::PolyOscillor m_oscillor{"OSC1"};
+    HeadlessHost m_host{m_oscillor};
+};
+
+class FilterCase : public BenchmarkCase {
+public:
+    explicit FilterCase(const juce::String& filterName) : m_filterName(filterName) {
+        m_filter.addAudioInput(&m_noise, m_noise.getOutputBuffer());
+        m_host = std::make_unique<HeadlessHost>(m_filter);
+        m_filter.changeFilter(filterName);
+    }
+
+    juce::String getName() const override { return "MainFilter/" + m_filterName; }
+
+    void prepare(FType sampleRate, size_t blockSize) override {
+        m_noise.prepare(sampleRate, blockSize);
+        m_filter.prepare(sampleRate, blockSize);
+        m_filter.prepareParameters(sampleRate, blockSize);
+    }
+
+    void processBlock(size_t numSamples) override {
+        m_filter.updateParameters(numSamples);
+        m_filter.process(0, numSamples);
+    }
+private:
+    juce::String m_filterName;
+    NoiseSource m_noise{"NOISE"};
+    audio::MainFilter m_filter{"FILTER1"};
+    std::unique_ptr<HeadlessHost> m_host;
+};
+
+class EffectsChainCase : public BenchmarkCase {
+public:
+    EffectsChainCase(bool flanger, bool phaser, bool barberpole)
+        : m_name(juce::String{"OrderableEffectsChain/"}
+                 + (flanger ? "Flanger" : "") + (flanger && phaser ? "+" : "") + (phaser ? "Phaser" : "")
+                 + (!flanger && !phaser ? "Bypass" : "")
+                 + (barberpole ? "/Barberpole" : "")) {
+        m_chain.setAudioInput(m_noise.getOutputBuffer());
+        m_host = std::make_unique<HeadlessHost>(m_chain);
+        m_host->setParameter(m_chain.combineWithID("Flanger_enable"), flanger ? 1.f : 0.f);
+        m_host->setParameter(m_chain.combineWithID("Phaser_enable"), phaser ? 1.f : 0.f);
+        m_host->setParameter(m_chain.combineWithID("Flanger_disBarber"), barberpole ? 0.f : 1.f);
+        m_host->setParameter(m_chain.combineWithID("Phaser_disBarber"), barberpole ? 0.f : 1.f);
+    }
+
+    juce::String getName() const override { return m_name; }
+
+    void prepare(FType sampleRate, size_t blockSize) override {
+        m_noise.prepare(sampleRate, blockSize);
+        m_chain.prepare(sampleRate, blockSize);
+        m_chain.prepareParameters(sampleRate, blockSize);
+    }
+
+    void processBlock(size_t numSamples) override {
+        m_chain.updateParameters(numSamples);
+        m_chain.process(0, numSamples);
+    }
+private:
+    juce::String m_name;
+    NoiseSource m_noise{"NOISE"};
+    audio::OrderableEffectsChain m_chain{"FXS"};
+    std::unique_ptr<HeadlessHost> m_host;
+};
+
+class ModulationCase : public BenchmarkCase {
+public:
+    explicit ModulationCase(size_t numLinks) : m_numLinks(numLinks) {
+        m_manager.addModulator(std::make_unique<audio::LFO>("LFO1"));
+        m_managerHost = std::make_unique<HeadlessHost>(m_manager);
+        m_targetsHost = std::make_unique<HeadlessHost>(m_targets);
+        m_manager.connectTo(m_matrix);
+        for (size_t i = 0; i < numLinks; i++) {
+            m_manager.getModulator(0)->addModulation(&m_targets.getParameter(i));
+        }
+    }
+
+    juce::String getName() const override { return "ModulationManager/" + juce::String{m_numLinks} + "links"; }
+
+    void prepare(FType sampleRate, size_t blockSize) override {
+        m_manager.prepare(sampleRate, blockSize);
+        m_manager.prepareParameters(sampleRate, blockSize);
+        m_targets.prepareParameters(sampleRate, blockSize);
+        m_matrix.prepare(sampleRate);
+        m_manager.noteOn();
+    }
+
+    void processBlock(size_t numSamples) override {
+        m_manager.updateParameters(numSamples);
+        m_targets.updateParameters(numSamples);
+        m_manager.process(0, numSamples);
+        m_matrix.process(0, numSamples);
+    }
+private:
+    size_t m_numLinks;
+    audio::ModulationManager m_manager{"LFOMODULATORS"};
+    audio::ModulationMatrix m_matrix;
+    ParameterBank m_targets{"TARGETS"};
+    std::unique_ptr<HeadlessHost> m_managerHost;
+    std::unique_ptr<HeadlessHost> m_targetsHost;
+};
+
+std::vector<std::unique_ptr<BenchmarkCase>> createAllCases() {
+    std::vector<std::unique_ptr<BenchmarkCase>> cases;
+    for (bool multithreaded : {false, true}) {
+        for (size_t numVoices : {size_t{1}, size_t{8}, size_t{16}, audio::PolyOscillor::kMaxPolyphonic}) {
+            cases.push_back(std::make_unique<OscillatorCase>(numVoices, multithreaded));
+        }
+    }
+
+    cases.push_back(std::make_unique<FilterCase>(audio::filters::LowPass::kName));
+    cases.push_back(std::make_unique<FilterCase>(audio::filters::HighPass::kName));
+    cases.push_back(std::make_unique<FilterCase>(audio::filters::analog::MoogLadderFilter::kName));
+
+    for (bool barberpole : {false, true}) {
+        cases.push_back(std::make_unique<EffectsChainCase>(true, false, barberpole));
+        cases.push_back(std::make_unique<EffectsChainCase>(false, true, barberpole));
+        cases.push_back(std::make_unique<EffectsChainCase>(true, true, barberpole));
+    }
+    cases.push_back(std::make_unique<EffectsChainCase>(false, false, false));
+
+    for (auto numLinks : kModulationLinks) {
+        cases.push_back(std::make_unique<ModulationCase>(numLinks));
+    }
+    return cases;
+}
+
+//================================================================================
+// Runner
+//================================================================================
+struct Result {
+    double nsPerSample;
+    double realtimeFactor;
+};
+
+Result run(BenchmarkCase& c, FType sampleRate, size_t blockSize, double seconds) {
+    c.prepare(sampleRate, blockSize);
+
+    // warm up caches and smoothers
+    for (int i = 0; i < 8; i++) {
+        c.processBlock(blockSize);
+    }
+
+    auto numBlocks = juce::jmax<size_t>(1, static_cast<size_t>(seconds * sampleRate / blockSize));
+    auto begin = juce::Time::getHighResolutionTicks();
+    for (size_t i = 0; i < numBlocks; i++) {
+        c.processBlock(blockSize);
+    }
+    auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - begin);
+
+    auto numSamples = static_cast<double>(numBlocks * blockSize);
+    return {elapsed * 1.0e9 / numSamples, elapsed > 0.0 ? numSamples / sampleRate / elapsed : 0.0};
+}
+}
+
+int main(int argc, char* argv[]) {
+    using namespace rpSynth::tools;
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args{argc, argv};
+
+    if (args.containsOption("--help|-h")) {
+        std::cout << "usage: ProcessorBenchmark [--case <name filter>] [--seconds <audio seconds per run>]\n";
+        return 0;
+    }
+
+    const auto caseFilter = args.getValueForOption("--case");
+    const double seconds = args.containsOption("--seconds")
+        ? args.getValueForOption("--seconds").getDoubleValue() : 1.0;
+
+    juce::ScopedNoDenormals noDenormals;
+    std::cout << "case,sample_rate,block_size,ns_per_sample,realtime_factor\n";
+    for (auto& c : createAllCases()) {
+        if (caseFilter.isNotEmpty() && !c->getName().containsIgnoreCase(caseFilter)) continue;
+
+        for (auto sampleRate : kSampleRates) {
+            for (auto blockSize : kBlockSizes) {
+                auto result = run(*c, sampleRate, blockSize, seconds);
+                std::cout << c->getName() << ',' << sampleRate << ',' << blockSize << ','
+                    << result.nsPerSample << ',' << result.realtimeFactor << '\n';
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    HeadlessHost.cpp
+    Created: 17 Oct 2026 9:12:40am
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#include "HeadlessHost.h"
+
+namespace rpSynth::tools {
+HeadlessHost::HeadlessHost(audio::AudioProcessorBase& processor)
+    : juce::AudioProcessor(BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo(), true))
+    , m_processor(processor) {
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    m_processor.addParameterToLayout(layout);
+    m_apvts = std::make_unique<juce::AudioProcessorValueTreeState>(*this,
+                                                                   nullptr,
+                                                                   g_myStrings.kAPVTSParameterTag,
+                                                                   std::move(layout));
+}
+
+HeadlessHost::~HeadlessHost() {
+    m_apvts = nullptr;
+}
+
+bool HeadlessHost::loadPreset(const juce::File& presetFile) {
+    auto xml = juce::parseXML(presetFile);
+    if (xml == nullptr || !xml->hasTagName(g_myStrings.kXMLConfigTag)) return false;
+
+    auto* apvtsXML = xml->getChildByName(g_myStrings.kAPVTSParameterTag);
+    if (apvtsXML == nullptr) return false;
+
+    m_apvts->replaceState(juce::ValueTree::fromXml(*apvtsXML));
+    m_processor.loadExtraState(*xml, *m_apvts);
+    return true;
+}
+
+bool HeadlessHost::setParameter(const juce::String& parameterID, float valueNotNormalized) {
+    auto* p = m_apvts->getParameter(parameterID);
+    if (p == nullptr) return false;
+
+    p->setValueNotifyingHost(p->convertTo0to1(valueNotNormalized));
+    return true;
+}
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    HeadlessHost.h
+    Created: 17 Oct 2026 9:12:40am
+    Author:  mana
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "synthesizer/AudioProcessorBase.h"
+
+namespace rpSynth::tools {
+/**
+ * @brief A minimal juce::AudioProcessor which only owns the parameter tree of
+ *        an AudioProcessorBase, so the engine can run without a plugin host.
+ *        Build the tools with RPSYNTH_HEADLESS=1,nothing in ui/ is needed.
+*/
+class HeadlessHost : public juce::AudioProcessor {
+public:
+    /**
+     * @brief Register all parameters of processor into an apvts
+     * @param processor The processor,it must live longer than this host
+    */
+    explicit HeadlessHost(audio::AudioProcessorBase& processor);
+    ~HeadlessHost() override;
+
+    /**
+     * @brief Load a preset,it is the same xml that the plugin writes in getStateInformation
+     * @param presetFile The xml file
+     * @return false if the file is not a valid preset
+    */
+    bool loadPreset(const juce::File& presetFile);
+
+    /**
+     * @brief Set a parameter by its ID
+     * @param parameterID The full parameter ID,for example "FXS_Flanger_enable"
+     * @param valueNotNormalized Value in the range of the parameter
+     * @return false if there is no such parameter
+    */
+    bool setParameter(const juce::String& parameterID, float valueNotNormalized);
+
+    juce::AudioProcessorValueTreeState& getValueTreeState() { return *m_apvts; }
+
+    //=========================================================================
+    // implement for juce::AudioProcessor,the host does not process anything
+    const juce::String getName() const override { return "RPBasicSynthesizerHeadless"; }
+    void prepareToPlay(double, int) override {}
+    void releaseResources() override {}
+    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+    double getTailLengthSeconds() const override { return 0.0; }
+    bool acceptsMidi() const override { return true; }
+    bool producesMidi() const override { return false; }
+    juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+    bool hasEditor() const override { return false; }
+    int getNumPrograms() override { return 1; }
+    int getCurrentProgram() override { return 0; }
+    void setCurrentProgram(int) override {}
+    const juce::String getProgramName(int) override { return {}; }
+    void changeProgramName(int, const juce::String&) override {}
+    void getStateInformation(juce::MemoryBlock&) override {}
+    void setStateInformation(const void*, int) override {}
+    //=========================================================================
+private:
+    audio::AudioProcessorBase& m_processor;
+    std::unique_ptr<juce::AudioProcessorValueTreeState> m_apvts;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessHost)
+};
+}
@@ -223,7 +223,7 @@ rpSynth::ui::FloatKnob::FloatKnob(audio::MyAudioProcessParameter* p)
     m_myPopUpMenu.addItem("edit modulation amount", [this] {
         if (m_currentShowingSetting == nullptr) return;
 
-        m_modulationAmountEditor.setText(juce::String(m_currentShowingSetting->amount), false);
+        m_modulationAmountEditor.setText(juce::String(m_currentShowingSetting->amount.load()), false);
         m_modulationAmountEditor.setVisible(true);
     });
 
@@ -14,9 +14,18 @@
 namespace rpSynth::ui {
 OscillorPanel::OscillorPanel(audio::PolyOscillor& osc)
     :m_knob_semitone(&osc.m_semitone)
-    , m_knob_volumeLevel(&osc.m_volumeLevel) {
+    , m_knob_volumeLevel(&osc.m_volumeLevel)
+    , m_attach_filterEnabled(*osc.m_filterEnabled, m_button_filterEnabled)
+    , m_knob_filterCutoff(&osc.m_filterCutoff)
+    , m_knob_filterResonance(&osc.m_filterResonance)
+    , m_knob_filterKeytrack(&osc.m_filterKeytrack) {
     addAndMakeVisible(m_knob_semitone);
     addAndMakeVisible(m_knob_volumeLevel);
+    m_button_filterEnabled.setButtonText(osc.m_filterEnabled->name);
+    addAndMakeVisible(m_button_filterEnabled);
+    addAndMakeVisible(m_knob_filterCutoff);
+    addAndMakeVisible(m_knob_filterResonance);
+    addAndMakeVisible(m_knob_filterKeytrack);
 }
 
 OscillorPanel::~OscillorPanel() {
@@ -25,6 +34,10 @@ OscillorPanel::~OscillorPanel() {
 void OscillorPanel::resized() {
     m_knob_semitone.setBoundsRelative(0.f, 0.f, 0.25f, 0.5f);
     m_knob_volumeLevel.setBoundsRelative(0.3f, 0.f, 0.25f, 0.5f);
+    m_button_filterEnabled.setBoundsRelative(0.6f, 0.f, 0.4f, 0.2f);
+    m_knob_filterCutoff.setBoundsRelative(0.f, 0.5f, 0.25f, 0.5f);
+    m_knob_filterResonance.setBoundsRelative(0.3f, 0.5f, 0.25f, 0.5f);
+    m_knob_filterKeytrack.setBoundsRelative(0.6f, 0.5f, 0.25f, 0.5f);
 }
 
 void OscillorPanel::paint(juce::Graphics& g) {
@@ -33,5 +46,8 @@ void OscillorPanel::paint(juce::Graphics& g) {
 void OscillorPanel::showModulationFrom(audio::ModulatorBase* p) {
     m_knob_semitone.showModulationFrom(p);
     m_knob_volumeLevel.showModulationFrom(p);
+    m_knob_filterCutoff.showModulationFrom(p);
+    m_knob_filterResonance.showModulationFrom(p);
+    m_knob_filterKeytrack.showModulationFrom(p);
 }
 }
\ No newline at end of file
@@ -29,6 +29,11 @@ public:
 private:
     FloatKnob m_knob_semitone;
     FloatKnob m_knob_volumeLevel;
+    juce::ToggleButton m_button_filterEnabled;
+    juce::ButtonParameterAttachment m_attach_filterEnabled;
+    FloatKnob m_knob_filterCutoff;
+    FloatKnob m_knob_filterResonance;
+    FloatKnob m_knob_filterKeytrack;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscillorPanel)
 };
 }
\ No newline at end of file